@@ -1,16 +1,188 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <optional>
 #include <functional>
+#include <string>
 
 namespace vsdb {
 
-template<typename Key, typename Value>
+// Keys of one node, stored as given and ordered by Compare
+template<typename Key, typename Compare>
+class PlainKeys {
+public:
+    size_t size() const { return keys_.size(); }
+    const Key& key(size_t i) const { return keys_[i]; }
+    
+    // First position whose key is not less (lower) / greater (upper) than `key`
+    size_t lower_bound(const Key& key, const Compare& less) const {
+        return std::lower_bound(keys_.begin(), keys_.end(), key, less) - keys_.begin();
+    }
+    size_t upper_bound(const Key& key, const Compare& less) const {
+        return std::upper_bound(keys_.begin(), keys_.end(), key, less) - keys_.begin();
+    }
+    bool equals(size_t i, const Key& key, const Compare& less) const {
+        return !less(key, keys_[i]) && !less(keys_[i], key);
+    }
+    
+    void insert(size_t i, const Key& key) { keys_.insert(keys_.begin() + i, key); }
+    
+    // Keep [0, mid), move (mid, size) to `right` and return the key at mid
+    Key split(size_t mid, PlainKeys& right) {
+        right.keys_.assign(keys_.begin() + mid + 1, keys_.end());
+        Key middle = std::move(keys_[mid]);
+        keys_.resize(mid);
+        return middle;
+    }
+    
+private:
+    std::vector<Key> keys_;
+};
+
+// String keys of one node with their common prefix stored once. Each
+// suffix also keeps its first 8 bytes as a big-endian integer, so most
+// comparisons inside a node are a single integer compare.
+class PrefixKeys {
+public:
+    size_t size() const { return suffixes_.size(); }
+    std::string key(size_t i) const { return prefix_ + suffixes_[i]; }
+    
+    size_t lower_bound(const std::string& key, const std::less<std::string>&) const {
+        return bound(key, false);
+    }
+    size_t upper_bound(const std::string& key, const std::less<std::string>&) const {
+        return bound(key, true);
+    }
+    bool equals(size_t i, const std::string& key, const std::less<std::string>&) const {
+        return key.size() == prefix_.size() + suffixes_[i].size() &&
+               key.compare(0, prefix_.size(), prefix_) == 0 &&
+               key.compare(prefix_.size(), std::string::npos, suffixes_[i]) == 0;
+    }
+    
+    void insert(size_t i, const std::string& key) {
+        if (suffixes_.empty()) {
+            prefix_ = key;
+        } else if (key.compare(0, prefix_.size(), prefix_) != 0) {
+            size_t common = 0;
+            while (common < prefix_.size() && common < key.size() && prefix_[common] == key[common]) {
+                common++;
+            }
+            set_prefix_length(common);
+        }
+        
+        std::string suffix = key.substr(prefix_.size());
+        abbrevs_.insert(abbrevs_.begin() + i, abbreviate(suffix, 0));
+        suffixes_.insert(suffixes_.begin() + i, std::move(suffix));
+    }
+    
+    std::string split(size_t mid, PrefixKeys& right) {
+        right.prefix_ = prefix_;
+        right.suffixes_.assign(suffixes_.begin() + mid + 1, suffixes_.end());
+        right.abbrevs_.assign(abbrevs_.begin() + mid + 1, abbrevs_.end());
+        std::string middle = key(mid);
+        
+        suffixes_.resize(mid);
+        abbrevs_.resize(mid);
+        
+        // Fewer keys can only share a longer prefix
+        extend_prefix();
+        right.extend_prefix();
+        return middle;
+    }
+    
+private:
+    std::string prefix_;
+    std::vector<std::string> suffixes_;
+    std::vector<uint64_t> abbrevs_;
+    
+    // First 8 bytes of s from `offset`, zero padded; ordering two of
+    // these agrees with ordering the strings unless they are equal
+    static uint64_t abbreviate(const std::string& s, size_t offset) {
+        uint64_t abbrev = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            unsigned char c = offset + i < s.size() ? static_cast<unsigned char>(s[offset + i]) : 0;
+            abbrev = (abbrev << 8) | c;
+        }
+        return abbrev;
+    }
+    
+    size_t bound(const std::string& key, bool upper) const {
+        // Keys all start with the prefix, so a probe outside it falls
+        // before or after all of them
+        int cmp = key.compare(0, prefix_.size(), prefix_);
+        if (cmp != 0) {
+            return cmp < 0 ? 0 : suffixes_.size();
+        }
+        
+        const size_t offset = prefix_.size();
+        const uint64_t abbrev = abbreviate(key, offset);
+        size_t low = 0, high = suffixes_.size();
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            int order; // Probe relative to keys[mid]
+            if (abbrev != abbrevs_[mid]) {
+                order = abbrev < abbrevs_[mid] ? -1 : 1;
+            } else {
+                order = key.compare(offset, std::string::npos, suffixes_[mid]);
+            }
+            
+            if (order > 0 || (upper && order == 0)) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+    
+    void set_prefix_length(size_t length) {
+        std::string moved = prefix_.substr(length);
+        for (size_t i = 0; i < suffixes_.size(); ++i) {
+            suffixes_[i].insert(0, moved);
+            abbrevs_[i] = abbreviate(suffixes_[i], 0);
+        }
+        prefix_.resize(length);
+    }
+    
+    void extend_prefix() {
+        if (suffixes_.empty()) return;
+        
+        // Keys are sorted, so the first and last share the common prefix
+        const std::string& first = suffixes_.front();
+        const std::string& last = suffixes_.back();
+        size_t common = 0;
+        while (common < first.size() && common < last.size() && first[common] == last[common]) {
+            common++;
+        }
+        if (common == 0) return;
+        
+        prefix_ += first.substr(0, common);
+        for (size_t i = 0; i < suffixes_.size(); ++i) {
+            suffixes_[i].erase(0, common);
+            abbrevs_[i] = abbreviate(suffixes_[i], 0);
+        }
+    }
+};
+
+// Node key layout for a key type and ordering. Prefix compression
+// relies on bytewise order, so it is used only for std::less<std::string>.
+template<typename Key, typename Compare>
+struct BTreeKeyStorage {
+    using type = PlainKeys<Key, Compare>;
+};
+
+template<>
+struct BTreeKeyStorage<std::string, std::less<std::string>> {
+    using type = PrefixKeys;
+};
+
+template<typename Key, typename Value, typename Compare = std::less<Key>>
 class BTreeNode {
 public:
-    std::vector<Key> keys;
+    typename BTreeKeyStorage<Key, Compare>::type keys;
     std::vector<Value> values;
     std::vector<std::shared_ptr<BTreeNode>> children;
     bool is_leaf;
@@ -20,40 +192,52 @@ public:
     size_t size() const { return keys.size(); }
 };
 
-template<typename Key, typename Value>
+// B-tree ordered by `Compare`. Composite keys work through a comparator
+// over their parts, e.g. BTree<CompositeKey, V, CompositeKeyLess>.
+template<typename Key, typename Value, typename Compare = std::less<Key>>
 class BTree {
 public:
-    BTree(int order = 3) : order_(order), root_(nullptr) {}
+    using Node = BTreeNode<Key, Value, Compare>;
+    
+    BTree(int order = 3, Compare compare = Compare())
+        : order_(order), less_(std::move(compare)), root_(nullptr) {}
     
     void insert(const Key& key, const Value& value);
     std::optional<Value> search(const Key& key) const;
+    Value* find(const Key& key);
     bool remove(const Key& key);
     void traverse(std::function<void(const Key&, const Value&)> callback) const;
     
+    // Visit keys in [low, high] in order; an empty bound is unbounded
+    void scan_range(const std::optional<Key>& low, const std::optional<Key>& high,
+                    std::function<void(const Key&, const Value&)> callback) const;
+    
     bool empty() const { return root_ == nullptr; }
     
 private:
     int order_; // Maximum number of children
-    std::shared_ptr<BTreeNode<Key, Value>> root_;
+    Compare less_;
+    std::shared_ptr<Node> root_;
     
-    void insert_non_full(std::shared_ptr<BTreeNode<Key, Value>> node, const Key& key, const Value& value);
-    void split_child(std::shared_ptr<BTreeNode<Key, Value>> parent, int index);
-    std::optional<Value> search_node(std::shared_ptr<BTreeNode<Key, Value>> node, const Key& key) const;
-    void traverse_node(std::shared_ptr<BTreeNode<Key, Value>> node, std::function<void(const Key&, const Value&)> callback) const;
+    void insert_non_full(std::shared_ptr<Node> node, const Key& key, const Value& value);
+    void split_child(std::shared_ptr<Node> parent, int index);
+    void traverse_node(std::shared_ptr<Node> node, std::function<void(const Key&, const Value&)> callback) const;
+    void scan_range_node(std::shared_ptr<Node> node, const std::optional<Key>& low, const std::optional<Key>& high,
+                         std::function<void(const Key&, const Value&)> callback) const;
 };
 
 // Implementation
-template<typename Key, typename Value>
-void BTree<Key, Value>::insert(const Key& key, const Value& value) {
+template<typename Key, typename Value, typename Compare>
+void BTree<Key, Value, Compare>::insert(const Key& key, const Value& value) {
     if (!root_) {
-        root_ = std::make_shared<BTreeNode<Key, Value>>(true);
-        root_->keys.push_back(key);
+        root_ = std::make_shared<Node>(true);
+        root_->keys.insert(0, key);
         root_->values.push_back(value);
         return;
     }
     
     if (root_->size() == 2 * order_ - 1) {
-        auto new_root = std::make_shared<BTreeNode<Key, Value>>(false);
+        auto new_root = std::make_shared<Node>(false);
         new_root->children.push_back(root_);
         split_child(new_root, 0);
         root_ = new_root;
@@ -62,108 +246,93 @@ void BTree<Key, Value>::insert(const Key& key, const Value& value) {
     insert_non_full(root_, key, value);
 }
 
-template<typename Key, typename Value>
-void BTree<Key, Value>::insert_non_full(std::shared_ptr<BTreeNode<Key, Value>> node, const Key& key, const Value& value) {
-    int i = node->size() - 1;
+template<typename Key, typename Value, typename Compare>
+void BTree<Key, Value, Compare>::insert_non_full(std::shared_ptr<Node> node, const Key& key, const Value& value) {
+    // Equal keys go after the existing ones
+    size_t i = node->keys.upper_bound(key, less_);
     
     if (node->is_leaf) {
-        node->keys.push_back(Key());
-        node->values.push_back(Value());
-        
-        while (i >= 0 && key < node->keys[i]) {
-            node->keys[i + 1] = node->keys[i];
-            node->values[i + 1] = node->values[i];
-            i--;
-        }
-        
-        node->keys[i + 1] = key;
-        node->values[i + 1] = value;
-    } else {
-        while (i >= 0 && key < node->keys[i]) {
-            i--;
-        }
-        i++;
-        
-        if (node->children[i]->size() == 2 * order_ - 1) {
-            split_child(node, i);
-            if (key > node->keys[i]) {
-                i++;
-            }
+        node->keys.insert(i, key);
+        node->values.insert(node->values.begin() + i, value);
+        return;
+    }
+    
+    if (node->children[i]->size() == 2 * order_ - 1) {
+        split_child(node, i);
+        if (less_(node->keys.key(i), key)) {
+            i++;
         }
-        
-        insert_non_full(node->children[i], key, value);
     }
+    
+    insert_non_full(node->children[i], key, value);
 }
 
-template<typename Key, typename Value>
-void BTree<Key, Value>::split_child(std::shared_ptr<BTreeNode<Key, Value>> parent, int index) {
+template<typename Key, typename Value, typename Compare>
+void BTree<Key, Value, Compare>::split_child(std::shared_ptr<Node> parent, int index) {
     auto full_child = parent->children[index];
-    auto new_child = std::make_shared<BTreeNode<Key, Value>>(full_child->is_leaf);
+    auto new_child = std::make_shared<Node>(full_child->is_leaf);
     
     int mid = order_ - 1;
     
     // Move second half of keys/values to new child
-    for (int i = mid + 1; i < full_child->size(); i++) {
-        new_child->keys.push_back(full_child->keys[i]);
-        new_child->values.push_back(full_child->values[i]);
-    }
+    Key middle = full_child->keys.split(mid, new_child->keys);
+    new_child->values.assign(full_child->values.begin() + mid + 1, full_child->values.end());
     
     if (!full_child->is_leaf) {
-        for (int i = mid + 1; i <= full_child->children.size() - 1; i++) {
-            new_child->children.push_back(full_child->children[i]);
-        }
+        new_child->children.assign(full_child->children.begin() + mid + 1, full_child->children.end());
         full_child->children.resize(mid + 1);
     }
     
     // Move middle key up to parent
-    parent->keys.insert(parent->keys.begin() + index, full_child->keys[mid]);
+    parent->keys.insert(index, middle);
     parent->values.insert(parent->values.begin() + index, full_child->values[mid]);
     parent->children.insert(parent->children.begin() + index + 1, new_child);
     
     // Shrink full_child
-    full_child->keys.resize(mid);
     full_child->values.resize(mid);
 }
 
-template<typename Key, typename Value>
-std::optional<Value> BTree<Key, Value>::search(const Key& key) const {
-    if (!root_) return std::nullopt;
-    return search_node(root_, key);
+template<typename Key, typename Value, typename Compare>
+std::optional<Value> BTree<Key, Value, Compare>::search(const Key& key) const {
+    auto node = root_;
+    while (node) {
+        size_t i = node->keys.lower_bound(key, less_);
+        if (i < node->size() && node->keys.equals(i, key, less_)) {
+            return node->values[i];
+        }
+        node = node->is_leaf ? nullptr : node->children[i];
+    }
+    return std::nullopt;
 }
 
-template<typename Key, typename Value>
-std::optional<Value> BTree<Key, Value>::search_node(std::shared_ptr<BTreeNode<Key, Value>> node, const Key& key) const {
-    int i = 0;
-    while (i < node->size() && key > node->keys[i]) {
-        i++;
-    }
-    
-    if (i < node->size() && key == node->keys[i]) {
-        return node->values[i];
-    }
-    
-    if (node->is_leaf) {
-        return std::nullopt;
+template<typename Key, typename Value, typename Compare>
+Value* BTree<Key, Value, Compare>::find(const Key& key) {
+    auto node = root_;
+    while (node) {
+        size_t i = node->keys.lower_bound(key, less_);
+        if (i < node->size() && node->keys.equals(i, key, less_)) {
+            return &node->values[i];
+        }
+        node = node->is_leaf ? nullptr : node->children[i];
     }
-    
-    return search_node(node->children[i], key);
+    return nullptr;
 }
 
-template<typename Key, typename Value>
-void BTree<Key, Value>::traverse(std::function<void(const Key&, const Value&)> callback) const {
+template<typename Key, typename Value, typename Compare>
+void BTree<Key, Value, Compare>::traverse(std::function<void(const Key&, const Value&)> callback) const {
     if (root_) {
         traverse_node(root_, callback);
     }
 }
 
-template<typename Key, typename Value>
-void BTree<Key, Value>::traverse_node(std::shared_ptr<BTreeNode<Key, Value>> node, std::function<void(const Key&, const Value&)> callback) const {
-    int i;
+template<typename Key, typename Value, typename Compare>
+void BTree<Key, Value, Compare>::traverse_node(std::shared_ptr<Node> node, std::function<void(const Key&, const Value&)> callback) const {
+    size_t i;
     for (i = 0; i < node->size(); i++) {
         if (!node->is_leaf) {
             traverse_node(node->children[i], callback);
         }
-        callback(node->keys[i], node->values[i]);
+        callback(node->keys.key(i), node->values[i]);
     }
     
     if (!node->is_leaf) {
@@ -171,10 +340,41 @@ void BTree<Key, Value>::traverse_node(std::shared_ptr<BTreeNode<Key, Value>> nod
     }
 }
 
-template<typename Key, typename Value>
-bool BTree<Key, Value>::remove(const Key& key) {
+template<typename Key, typename Value, typename Compare>
+void BTree<Key, Value, Compare>::scan_range(const std::optional<Key>& low, const std::optional<Key>& high,
+                                            std::function<void(const Key&, const Value&)> callback) const {
+    if (root_) {
+        scan_range_node(root_, low, high, callback);
+    }
+}
+
+template<typename Key, typename Value, typename Compare>
+void BTree<Key, Value, Compare>::scan_range_node(std::shared_ptr<Node> node,
+                                                 const std::optional<Key>& low, const std::optional<Key>& high,
+                                                 std::function<void(const Key&, const Value&)> callback) const {
+    // Skip keys (and the subtrees left of them) below the lower bound
+    size_t i = low ? node->keys.lower_bound(*low, less_) : 0;
+    
+    for (; i < node->size(); i++) {
+        if (!node->is_leaf) {
+            scan_range_node(node->children[i], low, high, callback);
+        }
+        decltype(auto) key = node->keys.key(i);
+        if (high && less_(*high, key)) {
+            return;
+        }
+        callback(key, node->values[i]);
+    }
+    
+    if (!node->is_leaf) {
+        scan_range_node(node->children[i], low, high, callback);
+    }
+}
+
+template<typename Key, typename Value, typename Compare>
+bool BTree<Key, Value, Compare>::remove(const Key& key) {
     // Simplified: not implemented in basic version
     return false;
 }
 
-} // namespace vsdb
\ No newline at end of file
+} // namespace vsdb
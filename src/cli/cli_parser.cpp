@@ -10,6 +10,15 @@ ParsedCommand CLIParser::parse(int argc, char** argv) {
     
     ParsedCommand result;
     
+    // Global options are accepted before or after the subcommand
+    bool show_stats = false;
+    app.add_flag("--stats", show_stats, "Print operation counters and timings");
+    std::string db_path;
+    app.add_option("--db", db_path, "Database directory (default: current directory)");
+    std::string trace_path;
+    app.add_option("--trace", trace_path, "Write Chrome trace-event JSON to this file (or set VSDB_TRACE)");
+    app.fallthrough();
+    
     // INIT command
     auto* init_cmd = app.add_subcommand("init", "Initialize a new VSDB database");
     
@@ -18,7 +27,9 @@ ParsedCommand CLIParser::parse(int argc, char** argv) {
     std::string create_table;
     std::vector<std::string> create_cols;
     create_cmd->add_option("table", create_table, "Table name")->required();
-    create_cmd->add_option("--columns,-c", create_cols, "Column definitions (name:type)")->required();
+    create_cmd->add_option("--columns,-c", create_cols, "Column definitions (name:type[:pk])")->required();
+    std::string create_storage = "memory";
+    create_cmd->add_option("--storage", create_storage, "Storage engine: memory or paged");
     
     // INSERT command
     auto* insert_cmd = app.add_subcommand("insert", "Insert data into a table");
@@ -32,7 +43,45 @@ ParsedCommand CLIParser::parse(int argc, char** argv) {
     // SELECT command
     auto* select_cmd = app.add_subcommand("select", "Select data from a table");
     std::string select_table;
+    std::vector<std::string> select_filters;
     select_cmd->add_option("table", select_table, "Table name")->required();
+    std::vector<std::string> select_aggs;
+    std::vector<std::string> select_group_by;
+    select_cmd->add_option("--where,-w", select_filters, "Filters (column=value, column>=value, ...)");
+    select_cmd->add_option("--agg,-a", select_aggs, "Aggregates: count(*), sum(col), min(col), max(col), avg(col)");
+    select_cmd->add_option("--group-by,-g", select_group_by, "Group aggregates by columns");
+    std::string select_join;
+    std::string select_on;
+    size_t select_memory_mb = 256;
+    select_cmd->add_option("--join", select_join, "Table to equi-join with");
+    select_cmd->add_option("--on", select_on, "Join condition (a.x=b.y)");
+    select_cmd->add_option("--memory-mb", select_memory_mb, "Memory budget in MB before spilling to disk");
+    std::string select_order_by;
+    bool select_desc = false;
+    size_t select_limit = 0;
+    select_cmd->add_option("--order-by", select_order_by, "Sort rows by a column");
+    select_cmd->add_flag("--desc", select_desc, "Sort in descending order");
+    size_t select_offset = 0;
+    auto* limit_opt = select_cmd->add_option("--limit", select_limit, "Maximum number of rows to return");
+    select_cmd->add_option("--offset", select_offset, "Number of rows to skip");
+    std::string select_at;
+    select_cmd->add_option("--at", select_at, "Query the tables as of a commit (hash or HEAD); results are cached");
+    
+    // UPDATE command
+    auto* update_cmd = app.add_subcommand("update", "Update rows matching filters");
+    std::string update_table;
+    std::vector<std::string> update_sets;
+    std::vector<std::string> update_filters;
+    update_cmd->add_option("table", update_table, "Table name")->required();
+    update_cmd->add_option("--set,-s", update_sets, "Assignments (column=value)")->required();
+    update_cmd->add_option("--where,-w", update_filters, "Filters (column=value, column>=value, ...)");
+    
+    // DELETE command
+    auto* delete_cmd = app.add_subcommand("delete", "Delete rows matching filters");
+    std::string delete_table;
+    std::vector<std::string> delete_filters;
+    delete_cmd->add_option("table", delete_table, "Table name")->required();
+    delete_cmd->add_option("--where,-w", delete_filters, "Filters (column=value, column>=value, ...)");
     
     // COMMIT command
     auto* commit_cmd = app.add_subcommand("commit", "Commit current changes");
@@ -47,6 +96,87 @@ ParsedCommand CLIParser::parse(int argc, char** argv) {
     std::string checkout_hash;
     checkout_cmd->add_option("commit", checkout_hash, "Commit hash")->required();
     
+    // CREATE-INDEX command
+    auto* index_cmd = app.add_subcommand("create-index", "Create a secondary index on a column");
+    std::string index_table;
+    std::string index_column;
+    index_cmd->add_option("table", index_table, "Table name")->required();
+    index_cmd->add_option("column", index_column, "Column name")->required();
+    
+    // ADD-COLUMN / DROP-COLUMN commands
+    auto* add_column_cmd = app.add_subcommand("add-column", "Add a column to a table without rewriting its rows");
+    std::string add_column_table;
+    std::string add_column_def;
+    std::string add_column_default;
+    add_column_cmd->add_option("table", add_column_table, "Table name")->required();
+    add_column_cmd->add_option("column", add_column_def, "Column as name:type")->required();
+    add_column_cmd->add_option("--default", add_column_default, "Value of the column in existing rows");
+    
+    auto* drop_column_cmd = app.add_subcommand("drop-column", "Drop a column from a table without rewriting its rows");
+    std::string drop_column_table;
+    std::string drop_column_name;
+    drop_column_cmd->add_option("table", drop_column_table, "Table name")->required();
+    drop_column_cmd->add_option("column", drop_column_name, "Column name")->required();
+    
+    // EXPORT command
+    auto* export_cmd = app.add_subcommand("export", "Stream a table to stdout as CSV, JSON lines or binary");
+    std::string export_table;
+    std::string export_format = "csv";
+    std::string export_at;
+    size_t export_threads = 0;
+    export_cmd->add_option("table", export_table, "Table name")->required();
+    export_cmd->add_option("--format", export_format, "csv (default), jsonl or binary");
+    export_cmd->add_option("--at", export_at, "Commit hash or HEAD to export instead of the working table");
+    auto* export_threads_opt = export_cmd->add_option("--threads", export_threads, "Formatting threads");
+    
+    // STATS command
+    auto* stats_cmd = app.add_subcommand("stats", "Summarize the object store and tables");
+    
+    // PRUNE command
+    auto* prune_cmd = app.add_subcommand("prune", "Squash old history and delete unreachable objects");
+    size_t prune_keep_last = 0;
+    size_t prune_keep_days = 0;
+    bool prune_dry_run = false;
+    auto* keep_last_opt = prune_cmd->add_option("--keep-last", prune_keep_last, "Keep the newest N commits");
+    auto* keep_days_opt = prune_cmd->add_option("--keep-days", prune_keep_days, "Keep commits from the last N days");
+    prune_cmd->add_flag("--dry-run", prune_dry_run, "Report what would be removed without deleting");
+    
+    // EXEC command
+    auto* exec_cmd = app.add_subcommand("exec", "Run commands from a script, one per line");
+    std::string exec_script = "-";
+    bool exec_keep_going = false;
+    exec_cmd->add_option("script", exec_script, "Script file, or - for stdin (default)");
+    exec_cmd->add_flag("--keep-going", exec_keep_going, "Continue after a command fails");
+    
+    // WORKTREE commands
+    auto* worktree_cmd = app.add_subcommand("worktree", "Manage read-only worktrees of past commits");
+    worktree_cmd->require_subcommand(1);
+    auto* worktree_add_cmd = worktree_cmd->add_subcommand("add", "Materialize a commit in a new directory");
+    std::string worktree_dir;
+    std::string worktree_commit;
+    worktree_add_cmd->add_option("dir", worktree_dir, "Worktree directory")->required();
+    worktree_add_cmd->add_option("commit", worktree_commit, "Commit hash or HEAD")->required();
+    auto* worktree_list_cmd = worktree_cmd->add_subcommand("list", "List worktrees");
+    auto* worktree_remove_cmd = worktree_cmd->add_subcommand("remove", "Delete a worktree");
+    std::string worktree_remove_dir;
+    worktree_remove_cmd->add_option("dir", worktree_remove_dir, "Worktree directory")->required();
+    
+    // FSCK command
+    auto* fsck_cmd = app.add_subcommand("fsck", "Verify the object store and commit history");
+    bool fsck_full = false;
+    size_t fsck_threads = 0;
+    fsck_cmd->add_flag("--full", fsck_full, "Rehash every object, not only new or changed ones");
+    auto* threads_opt = fsck_cmd->add_option("--threads", fsck_threads, "Verification threads");
+    
+    // PROVE command
+    auto* prove_cmd = app.add_subcommand("prove", "Print an inclusion proof of a row in a commit");
+    std::string prove_table;
+    size_t prove_row = 0;
+    std::string prove_at = "HEAD";
+    prove_cmd->add_option("table", prove_table, "Table name")->required();
+    prove_cmd->add_option("row", prove_row, "Row id")->required();
+    prove_cmd->add_option("--at", prove_at, "Commit hash or HEAD (default)");
+    
     try {
         app.parse(argc, argv);
     } catch (const CLI::ParseError& e) {
@@ -61,6 +191,7 @@ ParsedCommand CLIParser::parse(int argc, char** argv) {
         result.cmd = Command::CREATE_TABLE;
         result.table_name = create_table;
         result.columns = create_cols;
+        result.storage = create_storage;
     } else if (app.got_subcommand(insert_cmd)) {
         result.cmd = Command::INSERT;
         result.table_name = insert_table;
@@ -69,6 +200,28 @@ ParsedCommand CLIParser::parse(int argc, char** argv) {
     } else if (app.got_subcommand(select_cmd)) {
         result.cmd = Command::SELECT;
         result.table_name = select_table;
+        result.filters = select_filters;
+        result.aggregates = select_aggs;
+        result.group_by = select_group_by;
+        result.join_table = select_join;
+        result.join_on = select_on;
+        result.memory_mb = select_memory_mb;
+        result.order_by = select_order_by;
+        result.descending = select_desc;
+        if (limit_opt->count() > 0) {
+            result.limit = select_limit;
+        }
+        result.offset = select_offset;
+        result.at_commit = select_at;
+    } else if (app.got_subcommand(update_cmd)) {
+        result.cmd = Command::UPDATE;
+        result.table_name = update_table;
+        result.assignments = update_sets;
+        result.filters = update_filters;
+    } else if (app.got_subcommand(delete_cmd)) {
+        result.cmd = Command::DELETE;
+        result.table_name = delete_table;
+        result.filters = delete_filters;
     } else if (app.got_subcommand(commit_cmd)) {
         result.cmd = Command::COMMIT;
         result.commit_message = commit_msg;
@@ -77,8 +230,68 @@ ParsedCommand CLIParser::parse(int argc, char** argv) {
     } else if (app.got_subcommand(checkout_cmd)) {
         result.cmd = Command::CHECKOUT;
         result.commit_hash = checkout_hash;
+    } else if (app.got_subcommand(stats_cmd)) {
+        result.cmd = Command::STATS;
+    } else if (app.got_subcommand(index_cmd)) {
+        result.cmd = Command::CREATE_INDEX;
+        result.table_name = index_table;
+        result.index_column = index_column;
+    } else if (app.got_subcommand(add_column_cmd)) {
+        result.cmd = Command::ADD_COLUMN;
+        result.table_name = add_column_table;
+        result.columns = {add_column_def};
+        result.default_value = add_column_default;
+    } else if (app.got_subcommand(drop_column_cmd)) {
+        result.cmd = Command::DROP_COLUMN;
+        result.table_name = drop_column_table;
+        result.column_name = drop_column_name;
+    } else if (app.got_subcommand(export_cmd)) {
+        result.cmd = Command::EXPORT;
+        result.table_name = export_table;
+        result.export_format = export_format;
+        result.at_commit = export_at;
+        if (export_threads_opt->count() > 0) {
+            result.threads = export_threads;
+        }
+    } else if (app.got_subcommand(prune_cmd)) {
+        result.cmd = Command::PRUNE;
+        if (keep_last_opt->count() > 0) {
+            result.keep_last = prune_keep_last;
+        }
+        if (keep_days_opt->count() > 0) {
+            result.keep_days = prune_keep_days;
+        }
+        result.dry_run = prune_dry_run;
+    } else if (app.got_subcommand(exec_cmd)) {
+        result.cmd = Command::EXEC;
+        result.script_path = exec_script;
+        result.keep_going = exec_keep_going;
+    } else if (worktree_cmd->got_subcommand(worktree_add_cmd)) {
+        result.cmd = Command::WORKTREE_ADD;
+        result.worktree_dir = worktree_dir;
+        result.commit_hash = worktree_commit;
+    } else if (worktree_cmd->got_subcommand(worktree_list_cmd)) {
+        result.cmd = Command::WORKTREE_LIST;
+    } else if (worktree_cmd->got_subcommand(worktree_remove_cmd)) {
+        result.cmd = Command::WORKTREE_REMOVE;
+        result.worktree_dir = worktree_remove_dir;
+    } else if (app.got_subcommand(fsck_cmd)) {
+        result.cmd = Command::FSCK;
+        result.full_check = fsck_full;
+        if (threads_opt->count() > 0) {
+            result.threads = fsck_threads;
+        }
+    } else if (app.got_subcommand(prove_cmd)) {
+        result.cmd = Command::PROVE;
+        result.table_name = prove_table;
+        result.row_id = prove_row;
+        result.at_commit = prove_at;
     }
     
+    result.show_stats = show_stats;
+    result.db_path = db_path;
+    result.trace_path = trace_path;
+    
     return result;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -11,9 +12,23 @@ enum class Command {
     CREATE_TABLE,
     INSERT,
     SELECT,
+    UPDATE,
+    DELETE,
     COMMIT,
     LOG,
-    CHECKOUT
+    CHECKOUT,
+    STATS,
+    CREATE_INDEX,
+    PRUNE,
+    EXEC,
+    WORKTREE_ADD,
+    WORKTREE_LIST,
+    WORKTREE_REMOVE,
+    FSCK,
+    PROVE,
+    ADD_COLUMN,
+    DROP_COLUMN,
+    EXPORT
 };
 
 struct ParsedCommand {
@@ -21,8 +36,37 @@ struct ParsedCommand {
     std::string table_name;
     std::vector<std::string> columns;
     std::vector<std::string> values;
+    std::string storage = "memory"; // Table storage: memory or paged
+    std::vector<std::string> filters; // "column<op>value" expressions
+    std::vector<std::string> assignments; // update: "column=value"
+    std::string index_column;
+    std::string column_name;    // drop-column
+    std::string default_value;  // add-column: value of the column in existing rows
+    std::vector<std::string> aggregates; // e.g. "count(*)", "sum(amount)"
+    std::vector<std::string> group_by;
+    std::string join_table;
+    std::string join_on;      // "left.column=right.column"
+    size_t memory_mb = 256;   // Budget before operators spill to disk
+    std::string order_by;
+    bool descending = false;
+    std::optional<size_t> limit;
+    size_t offset = 0;
+    std::string at_commit;    // select: commit (or HEAD) to query instead of the working tables
     std::string commit_message;
     std::string commit_hash;
+    std::optional<size_t> keep_last; // Prune retention: newest commits kept
+    std::optional<size_t> keep_days; // Prune retention: commits younger than this kept
+    bool dry_run = false;
+    std::string script_path;  // exec: "-" reads commands from stdin
+    bool keep_going = false;  // exec: continue after a failed command
+    std::string worktree_dir;
+    bool full_check = false;  // fsck: rehash objects verified before
+    std::optional<size_t> threads; // fsck: verification threads; export: formatting threads
+    std::string export_format = "csv"; // export: csv, jsonl or binary
+    size_t row_id = 0;        // prove: row to prove
+    bool show_stats = false; // Print operation metrics after the command
+    std::string trace_path;  // Write a Chrome trace of the command here
+    std::string db_path;     // Empty for the current directory
 };
 
 class CLIParser {
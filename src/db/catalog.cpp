@@ -0,0 +1,142 @@
+#include "db/catalog.h"
+#include "util/atomic_file.h"
+#include "util/byte_codec.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace vsdb {
+
+namespace {
+
+// Version 2 adds schema versions, column ids and defaults
+constexpr char kMagic[8] = {'V', 'S', 'D', 'B', 'C', 'A', 'T', '2'};
+constexpr char kMagicV1[8] = {'V', 'S', 'D', 'B', 'C', 'A', 'T', '1'};
+
+} // namespace
+
+bool Catalog::load(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string bytes = buffer.str();
+    
+    // Magic, payload, then a checksum of the payload
+    if (bytes.size() < sizeof(kMagic) + sizeof(uint64_t)) {
+        return false;
+    }
+    bool v1 = std::memcmp(bytes.data(), kMagicV1, sizeof(kMagicV1)) == 0;
+    if (!v1 && std::memcmp(bytes.data(), kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    
+    const char* payload = bytes.data() + sizeof(kMagic);
+    size_t payload_size = bytes.size() - sizeof(kMagic) - sizeof(uint64_t);
+    uint64_t stored = 0;
+    std::memcpy(&stored, payload + payload_size, sizeof(stored));
+    if (stored != fnv1a_checksum(payload, payload_size)) {
+        return false;
+    }
+    
+    ByteDecoder in(payload, payload_size);
+    std::map<std::string, CatalogEntry> entries;
+    
+    uint32_t tables = in.u32();
+    for (uint32_t t = 0; t < tables && in.ok(); ++t) {
+        CatalogEntry entry;
+        entry.schema.table_name = in.str();
+        entry.schema.storage = static_cast<StorageType>(in.u8());
+        if (!v1) {
+            entry.schema.version = in.u32();
+            entry.schema.next_column_id = in.u32();
+        }
+        
+        // Version 1 columns are numbered by the table
+        uint32_t columns = in.u32();
+        for (uint32_t c = 0; c < columns && in.ok(); ++c) {
+            Column col;
+            col.name = in.str();
+            col.type = static_cast<DataType>(in.u8());
+            col.primary_key = in.u8() != 0;
+            if (!v1) {
+                col.id = in.u32();
+                col.default_value = in.str();
+            }
+            entry.schema.columns.push_back(col);
+        }
+        
+        entry.row_count = in.u64();
+        entry.data_bytes = in.u64();
+        
+        uint32_t files = in.u32();
+        for (uint32_t f = 0; f < files && in.ok(); ++f) {
+            entry.files.push_back(in.str());
+        }
+        
+        std::string name = entry.schema.table_name;
+        entries[name] = std::move(entry);
+    }
+    
+    if (!in.ok()) {
+        return false;
+    }
+    
+    entries_ = std::move(entries);
+    return true;
+}
+
+bool Catalog::save(const std::filesystem::path& path) const {
+    ByteEncoder out;
+    out.u32(static_cast<uint32_t>(entries_.size()));
+    
+    for (const auto& [name, entry] : entries_) {
+        out.str(name);
+        out.u8(static_cast<uint8_t>(entry.schema.storage));
+        out.u32(entry.schema.version);
+        out.u32(entry.schema.next_column_id);
+        
+        out.u32(static_cast<uint32_t>(entry.schema.columns.size()));
+        for (const auto& col : entry.schema.columns) {
+            out.str(col.name);
+            out.u8(static_cast<uint8_t>(col.type));
+            out.u8(col.primary_key ? 1 : 0);
+            out.u32(col.id);
+            out.str(col.default_value);
+        }
+        
+        out.u64(entry.row_count);
+        out.u64(entry.data_bytes);
+        
+        out.u32(static_cast<uint32_t>(entry.files.size()));
+        for (const auto& file : entry.files) {
+            out.str(file);
+        }
+    }
+    
+    const std::string& payload = out.bytes();
+    uint64_t sum = fnv1a_checksum(payload.data(), payload.size());
+    
+    return replace_file(path, [&](const std::filesystem::path& tmp_path) {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        
+        file.write(kMagic, sizeof(kMagic));
+        file.write(payload.data(), payload.size());
+        file.write(reinterpret_cast<const char*>(&sum), sizeof(sum));
+        return static_cast<bool>(file.flush());
+    });
+}
+
+void Catalog::put(CatalogEntry entry) {
+    std::string name = entry.schema.table_name;
+    entries_[name] = std::move(entry);
+}
+
+const CatalogEntry* Catalog::find(const std::string& table_name) const {
+    auto it = entries_.find(table_name);
+    return it != entries_.end() ? &it->second : nullptr;
+}
+
+} // namespace vsdb
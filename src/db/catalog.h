@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include "db/database.h"
+
+namespace vsdb {
+
+struct CatalogEntry {
+    TableSchema schema;
+    uint64_t row_count = 0;
+    uint64_t data_bytes = 0;          // Total size of `files`
+    std::vector<std::string> files;   // The table's files in data/
+};
+
+// Every table's schema, files and statistics in one binary file,
+// data/catalog, read with a single I/O when the database opens.
+// Rewritten atomically (temp file + rename) whenever a table changes.
+class Catalog {
+public:
+    static constexpr const char* kFileName = "catalog";
+    
+    // False if the file is missing or fails its checksum
+    bool load(const std::filesystem::path& path);
+    bool save(const std::filesystem::path& path) const;
+    
+    void put(CatalogEntry entry);
+    const CatalogEntry* find(const std::string& table_name) const;
+    const std::map<std::string, CatalogEntry>& entries() const { return entries_; }
+    
+private:
+    std::map<std::string, CatalogEntry> entries_;
+};
+
+} // namespace vsdb
@@ -1,27 +1,30 @@
 #include "db/database.h"
-#include <iostream>
+#include "db/catalog.h"
+#include "util/atomic_file.h"
+#include "util/byte_codec.h"
+#include "util/metrics.h"
+#include "util/sha256.h"
+#include "util/trace.h"
 #include <fstream>
 #include <sstream>
 #include <chrono>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
 
 namespace vsdb {
 
 // TableSchema Implementation
-bool TableSchema::save_to_file(const std::filesystem::path& path) const {
-    std::ofstream file(path);
-    if (!file.is_open()) return false;
-    
-    file << table_name << "\n";
-    file << columns.size() << "\n";
-    
-    for (const auto& col : columns) {
-        file << col.name << ","
-             << static_cast<int>(col.type) << ","
-             << col.primary_key << "\n";
+std::optional<size_t> TableSchema::find_column(const std::string& name) const {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].name == name) {
+            return i;
+        }
     }
-    
-    return true;
+    return std::nullopt;
 }
 
 TableSchema TableSchema::load_from_file(const std::filesystem::path& path) {
@@ -52,313 +55,2396 @@ TableSchema TableSchema::load_from_file(const std::filesystem::path& path) {
         schema.columns.push_back(col);
     }
     
+    // Optional trailing properties
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line == "storage=paged") {
+            schema.storage = StorageType::PAGED;
+        }
+    }
+    
     return schema;
 }
 
+std::optional<Assignment> Assignment::parse(const std::string& expr) {
+    size_t eq = expr.find('=');
+    if (eq == std::string::npos || eq == 0) {
+        return std::nullopt;
+    }
+    return Assignment{expr.substr(0, eq), expr.substr(eq + 1)};
+}
+
 // Table Implementation
 Table::Table(const std::string& name, const TableSchema& schema)
     : name_(name), schema_(schema) {
+    // Schemas from before column ids store column i at position i
+    if (schema_.next_column_id == 0) {
+        for (size_t col = 0; col < schema_.columns.size(); ++col) {
+            schema_.columns[col].id = static_cast<uint32_t>(col);
+        }
+        schema_.next_column_id = static_cast<uint32_t>(schema_.columns.size());
+    }
+    update_layout();
+    
+    rebuild_zones();
+    if (!key_columns_.empty()) {
+        rebuild_key_filter();
+    }
 }
 
-bool Table::insert(const Record& record) {
+Status Table::insert(const Record& record) {
     if (record.values.size() != schema_.columns.size()) {
-        std::cerr << "Error: Column count mismatch\n";
-        return false;
+        return Status::error("Column count mismatch");
     }
-    records_.push_back(record);
-    return true;
-}
-
-std::vector<Record> Table::select_all() const {
-    return records_;
+    
+    std::string key;
+    if (key_filter_) {
+        key = key_of(record.values);
+        if (key_exists(key)) {
+            return Status::error("Duplicate primary key in table '" + name_ + "'");
+        }
+    }
+    
+    size_t row_id = row_count();
+    
+    if (schema_.storage == StorageType::PAGED) {
+        if (!paged_) {
+            return Status::error("Paged storage for '" + name_ + "' is not open");
+        }
+        std::vector<std::string> stored;
+        if (!paged_->append(stored_row(record.values, stored))) {
+            return Status::error("Row exceeds " + std::to_string(PagedStore::max_row_bytes()) + " bytes");
+        }
+    } else {
+        records_.push_back(record);
+        for (auto& [column, dictionary] : dictionaries_) {
+            dictionary.append(record.values[column]);
+        }
+    }
+    
+    for (auto& [column, index] : indexes_) {
+        index->insert(record.values[*schema_.find_column(column)], row_id);
+    }
+    
+    zones_.add(record.values);
+    touch_block(row_id);
+    
+    if (key_filter_) {
+        key_filter_->add(key);
+        filter_dirty_ = true;
+        if (key_filter_->key_count() > key_filter_->capacity()) {
+            rebuild_key_filter();
+        }
+    }
+    
+    base_dirty_ = true;
+    return Status::ok();
 }
 
-std::filesystem::path Table::get_schema_path(const std::filesystem::path& data_dir) const {
-    return data_dir / (name_ + ".schema");
+Status Table::matching_rows(const std::vector<Predicate>& predicates, std::vector<size_t>* rows) const {
+    ScanOptions options;
+    options.predicates = predicates;
+    
+    std::unique_ptr<TableCursor> cursor;
+    if (Status status = open_cursor(options, &cursor); !status) {
+        return status;
+    }
+    cursor->track_rows();
+    
+    std::vector<Record> batch;
+    rows->clear();
+    while (cursor->next_batch(batch)) {
+        rows->insert(rows->end(), cursor->batch_rows_.begin(), cursor->batch_rows_.end());
+    }
+    return cursor->status();
 }
 
-std::filesystem::path Table::get_data_path(const std::filesystem::path& data_dir) const {
-    return data_dir / (name_ + ".data");
+Status Table::delete_where(const std::vector<Predicate>& predicates, size_t* count) {
+    std::vector<size_t> rows;
+    if (Status status = matching_rows(predicates, &rows); !status) {
+        return status;
+    }
+    
+    if (deleted_.size() < row_count()) {
+        deleted_.resize(row_count(), false);
+    }
+    for (size_t row_id : rows) {
+        deleted_[row_id] = true;
+        versions_.erase(row_id);
+        touch_block(row_id);
+    }
+    deleted_count_ += rows.size();
+    
+    if (!rows.empty()) {
+        delta_dirty_ = true;
+    }
+    *count = rows.size();
+    return Status::ok();
 }
 
-bool Table::save_to_disk(const std::filesystem::path& data_dir) {
-    // Save schema
-    if (!schema_.save_to_file(get_schema_path(data_dir))) {
-        return false;
+Status Table::update_where(const std::vector<Predicate>& predicates,
+                           const std::vector<Assignment>& assignments, size_t* count) {
+    std::vector<std::pair<size_t, std::string>> sets;
+    bool sets_key = false;
+    for (const auto& assignment : assignments) {
+        auto col = schema_.find_column(assignment.column);
+        if (!col) {
+            return Status::error("Unknown column '" + assignment.column + "'");
+        }
+        sets.emplace_back(*col, assignment.value);
+        sets_key = sets_key || schema_.columns[*col].primary_key;
     }
     
-    // Save data
-    std::ofstream data_file(get_data_path(data_dir));
-    if (!data_file.is_open()) return false;
+    std::vector<size_t> rows;
+    if (Status status = matching_rows(predicates, &rows); !status) {
+        return status;
+    }
     
-    data_file << records_.size() << "\n";
+    // New versions of every matching row, checked before any is applied
+    std::vector<Record> updated;
+    updated.reserve(rows.size());
+    std::unordered_set<std::string> new_keys;
+    Record scratch;
     
-    for (const auto& record : records_) {
-        for (size_t i = 0; i < record.values.size(); ++i) {
-            data_file << record.values[i];
-            if (i < record.values.size() - 1) {
-                data_file << ",";
+    for (size_t row_id : rows) {
+        const Record* current = row_at(row_id, scratch);
+        if (!current) {
+            return Status::error("Failed to read row " + std::to_string(row_id) + " of table '" + name_ + "'");
+        }
+        Record version = *current;
+        for (const auto& [col, value] : sets) {
+            version.values[col] = value;
+        }
+        
+        if (sets_key) {
+            std::string key = key_of(version.values);
+            if (!new_keys.insert(key).second ||
+                (key != key_of(current->values) && key_exists(key))) {
+                return Status::error("Duplicate primary key in table '" + name_ + "'");
             }
         }
-        data_file << "\n";
+        updated.push_back(std::move(version));
     }
     
-    return true;
-}
-
-std::unique_ptr<Table> Table::load_from_disk(
-    const std::filesystem::path& data_dir,
-    const std::string& table_name
-) {
-    std::filesystem::path schema_path = data_dir / (table_name + ".schema");
-    std::filesystem::path data_path = data_dir / (table_name + ".data");
-    
-    if (!std::filesystem::exists(schema_path)) {
-        return nullptr;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        size_t row_id = rows[i];
+        Record& version = updated[i];
+        
+        // Index the new values; entries for the old ones are filtered
+        // out when candidate rows are re-checked
+        for (auto& [column, index] : indexes_) {
+            index->insert(version.values[*schema_.find_column(column)], row_id);
+        }
+        zones_.widen(row_id, version.values);
+        touch_block(row_id);
+        if (key_filter_ && sets_key) {
+            key_filter_->add(key_of(version.values));
+            filter_dirty_ = true;
+        }
+        
+        versions_[row_id] = std::move(version);
     }
     
-    TableSchema schema = TableSchema::load_from_file(schema_path);
-    auto table = std::make_unique<Table>(table_name, schema);
+    if (key_filter_ && key_filter_->key_count() > key_filter_->capacity()) {
+        rebuild_key_filter();
+    }
     
-    if (std::filesystem::exists(data_path)) {
-        std::ifstream data_file(data_path);
-        size_t num_records;
-        data_file >> num_records;
-        data_file.ignore();
+    if (!rows.empty()) {
+        delta_dirty_ = true;
+    }
+    *count = rows.size();
+    return Status::ok();
+}
+
+bool Table::needs_compaction() const {
+    size_t superseded = deleted_count_ + versions_.size();
+    return superseded > 0 && superseded >= row_count() * kCompactionThreshold;
+}
+
+bool Table::compact(const std::filesystem::path& data_dir) {
+    if (schema_.storage == StorageType::PAGED) {
+        if (!paged_ && !open_paged_store(data_dir)) {
+            return false;
+        }
         
-        for (size_t i = 0; i < num_records; ++i) {
-            std::string line;
-            std::getline(data_file, line);
-            std::stringstream ss(line);
-            
-            Record record;
-            std::string value;
-            while (std::getline(ss, value, ',')) {
-                record.values.push_back(value);
+        // Write the current rows to staged page files
+        std::filesystem::path new_pages = data_dir / (name_ + ".pages.compact");
+        std::filesystem::path new_dir = data_dir / (name_ + ".pagedir.compact");
+        
+        std::error_code ec;
+        std::filesystem::remove(new_pages, ec);
+        std::filesystem::remove(new_dir, ec);
+        
+        auto store = PagedStore::open(new_pages, new_dir);
+        if (!store) {
+            return false;
+        }
+        
+        Record scratch;
+        std::vector<std::string> stored;
+        for (size_t row_id = 0; row_id < row_count(); ++row_id) {
+            const Record* record = row_at(row_id, scratch);
+            if (!record) {
+                if (is_deleted(row_id)) continue;
+                return false;
             }
+            if (!store->append(stored_row(record->values, stored))) {
+                return false;
+            }
+        }
+        if (!store->flush()) {
+            return false;
+        }
+        paged_ = std::move(store);
+    } else {
+        std::vector<Record> rows;
+        rows.reserve(live_row_count());
+        for (size_t row_id = 0; row_id < records_.size(); ++row_id) {
+            if (is_deleted(row_id)) continue;
             
-            table->insert(record);
+            auto version = versions_.find(row_id);
+            rows.push_back(std::move(version != versions_.end() ? version->second : records_[row_id]));
         }
+        records_ = std::move(rows);
+        
+        // Re-chosen from the new rows on save
+        dictionaries_.clear();
     }
     
-    return table;
+    deleted_.clear();
+    deleted_count_ = 0;
+    versions_.clear();
+    block_hashes_.clear();
+    rows_dirty_ = true;
+    
+    rebuild_zones();
+    if (key_filter_) {
+        rebuild_key_filter();
+    }
+    
+    std::vector<std::string> indexed;
+    for (const auto& [column, index] : indexes_) {
+        indexed.push_back(column);
+    }
+    indexes_.clear();
+    for (const auto& column : indexed) {
+        (void)create_index(column);
+    }
+    
+    base_dirty_ = true;
+    delta_dirty_ = true;
+    compaction_pending_ = true;
+    Metrics::instance().add(Counter::TABLES_COMPACTED);
+    return true;
 }
 
-// Database Implementation
-Database::Database() 
-    : db_root_(std::filesystem::current_path()) {
-    if (is_initialized()) {
-        git_store_ = std::make_unique<GitStore>(db_root_ / "objects");
-        load_tables();
+size_t Table::row_count() const {
+    return paged_ ? paged_->row_count() : records_.size();
+}
+
+const Record* Table::row_at(size_t row_id, Record& scratch) const {
+    if (is_deleted(row_id)) {
+        return nullptr;
+    }
+    if (!versions_.empty()) {
+        auto it = versions_.find(row_id);
+        if (it != versions_.end()) {
+            return &it->second;
+        }
     }
+    return base_row_at(row_id, scratch);
 }
 
-bool Database::is_initialized() const {
-    return std::filesystem::exists(db_root_ / ".vsdb");
+const Record* Table::base_row_at(size_t row_id, Record& scratch) const {
+    if (paged_) {
+        if (!paged_->read_row(row_id, scratch.values)) {
+            return nullptr;
+        }
+        adapt_row(scratch.values);
+        return &scratch;
+    }
+    return row_id < records_.size() ? &records_[row_id] : nullptr;
 }
 
-std::filesystem::path Database::get_db_path() const {
-    return db_root_;
+void Table::touch_block(size_t row_id) {
+    size_t block = row_id / ZoneMap::kBlockRows;
+    if (block < block_hashes_.size()) {
+        block_hashes_[block].clear();
+    }
+    rows_dirty_ = true;
 }
 
-bool Database::initialize() {
-    if (is_initialized()) {
-        std::cerr << "Error: Database already initialized in this directory.\n";
-        return false;
+std::string Table::row_leaf(const Record* row) {
+    ByteEncoder out;
+    if (!row) {
+        out.u8(0);
+        return out.bytes();
     }
     
-    if (!create_directory_structure()) {
-        std::cerr << "Error: Failed to create directory structure.\n";
-        return false;
+    out.u8(1);
+    out.u32(static_cast<uint32_t>(row->values.size()));
+    for (const auto& value : row->values) {
+        out.str(value);
     }
+    return out.bytes();
+}
+
+std::vector<std::string> Table::block_leaves(size_t block) const {
+    size_t begin = block * ZoneMap::kBlockRows;
+    size_t end = std::min(begin + ZoneMap::kBlockRows, row_count());
     
-    if (!create_config_file()) {
-        std::cerr << "Error: Failed to create configuration file.\n";
-        return false;
+    std::vector<std::string> leaves;
+    leaves.reserve(end - begin);
+    Record scratch;
+    for (size_t row_id = begin; row_id < end; ++row_id) {
+        leaves.push_back(row_leaf(row_at(row_id, scratch)));
     }
+    return leaves;
+}
+
+std::string Table::row_root() {
+    size_t blocks = (row_count() + ZoneMap::kBlockRows - 1) / ZoneMap::kBlockRows;
+    block_hashes_.resize(blocks);
     
-    std::cout << "Database initialized successfully in " << db_root_ << "\n";
-    std::cout << "Created directories:\n";
-    std::cout << "  - data/      (for table data storage)\n";
-    std::cout << "  - objects/   (for version control objects)\n";
-    
-    git_store_ = std::make_unique<GitStore>(db_root_ / "objects");
+    for (size_t block = 0; block < blocks; ++block) {
+        if (!block_hashes_[block].empty()) continue;
+        
+        block_hashes_[block] = MerkleTree(block_leaves(block)).root();
+        rows_dirty_ = true;
+        Metrics::instance().add(Counter::BLOCKS_HASHED);
+    }
     
-    return true;
+    return MerkleTree::from_hashes(block_hashes_).root();
 }
 
-bool Database::create_directory_structure() {
-    try {
-        std::filesystem::create_directories(db_root_ / "data");
-        std::filesystem::create_directories(db_root_ / "objects");
-        return true;
-    } catch (const std::filesystem::filesystem_error& e) {
-        std::cerr << "Filesystem error: " << e.what() << "\n";
-        return false;
+Status Table::prove_row(size_t row_id, RowProof* proof) {
+    if (row_id >= row_count()) {
+        return Status::error("Table '" + name_ + "' has no row " + std::to_string(row_id));
     }
+    
+    proof->row_root = row_root();
+    proof->table = name_;
+    proof->row_id = row_id;
+    
+    size_t block = row_id / ZoneMap::kBlockRows;
+    proof->block_path = MerkleTree(block_leaves(block)).proof(row_id % ZoneMap::kBlockRows);
+    proof->table_path = MerkleTree::from_hashes(block_hashes_).proof(block);
+    
+    Record scratch;
+    const Record* row = row_at(row_id, scratch);
+    proof->row = row ? std::make_optional(*row) : std::nullopt;
+    return Status::ok();
 }
 
-bool Database::create_config_file() {
-    try {
-        std::ofstream config_file(db_root_ / ".vsdb");
-        
-        if (!config_file.is_open()) {
-            return false;
-        }
-        
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-        
-        config_file << "version=1.0\n";
-        config_file << "initialized=" << ss.str() << "\n";
-        config_file << "format=vsdb\n";
-        
-        config_file.close();
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error creating config file: " << e.what() << "\n";
+bool RowProof::verify() const {
+    std::string leaf = MerkleTree::leaf_hash(Table::row_leaf(row ? &*row : nullptr));
+    std::string block = MerkleTree::root_from_proof(leaf, block_path);
+    if (MerkleTree::root_from_proof(block, table_path) != row_root) {
+        return false;
+    }
+    
+    std::string tree_leaf = MerkleTree::leaf_hash("rows:" + table + ":" + row_root);
+    if (MerkleTree::root_from_proof(tree_leaf, tree_path) != tree_root) {
         return false;
     }
+    return Sha256::hex(header + "root=" + tree_root + "\n") == commit;
 }
 
-bool Database::load_tables() {
-    std::filesystem::path data_dir = db_root_ / "data";
+bool Table::open_paged_store(const std::filesystem::path& data_dir) {
+    paged_ = PagedStore::open(data_dir / (name_ + ".pages"), data_dir / (name_ + ".pagedir"));
+    return paged_ != nullptr;
+}
+
+void Table::update_layout() {
+    const auto& columns = schema_.columns;
     
-    if (!std::filesystem::exists(data_dir)) {
-        return true;
+    identity_layout_ = schema_.next_column_id == columns.size();
+    key_columns_.clear();
+    for (size_t col = 0; col < columns.size(); ++col) {
+        identity_layout_ = identity_layout_ && columns[col].id == col;
+        if (columns[col].primary_key) {
+            key_columns_.push_back(col);
+        }
     }
+}
+
+void Table::adapt_row(std::vector<std::string>& values) const {
+    const auto& columns = schema_.columns;
     
-    for (const auto& entry : std::filesystem::directory_iterator(data_dir)) {
-        if (entry.path().extension() == ".schema") {
-            std::string table_name = entry.path().stem().string();
-            auto table = Table::load_from_disk(data_dir, table_name);
-            
-            if (table) {
-                tables_[table_name] = std::move(table);
-            }
+    // Rows written before columns were added are short
+    if (identity_layout_) {
+        while (values.size() < columns.size()) {
+            values.push_back(columns[values.size()].default_value);
         }
+        return;
     }
     
-    return true;
+    std::vector<std::string> row;
+    row.reserve(columns.size());
+    for (const auto& col : columns) {
+        row.push_back(col.id < values.size() ? std::move(values[col.id]) : col.default_value);
+    }
+    values = std::move(row);
 }
 
-bool Database::create_table(const std::string& name, const std::vector<Column>& columns) {
-    if (!is_initialized()) {
-        std::cerr << "Error: Database not initialized\n";
-        return false;
+const std::vector<std::string>& Table::stored_row(const std::vector<std::string>& values,
+                                                  std::vector<std::string>& scratch) const {
+    if (identity_layout_) {
+        return values;
     }
     
-    if (table_exists(name)) {
-        std::cerr << "Error: Table '" << name << "' already exists\n";
-        return false;
+    // Positions of dropped columns stay, empty
+    scratch.assign(schema_.next_column_id, std::string());
+    for (size_t col = 0; col < schema_.columns.size(); ++col) {
+        scratch[schema_.columns[col].id] = values[col];
+    }
+    return scratch;
+}
+
+Status Table::add_column(const Column& column) {
+    if (schema_.find_column(column.name)) {
+        return Status::error("Column '" + column.name + "' already exists in table '" + name_ + "'");
+    }
+    if (column.primary_key) {
+        return Status::error("Cannot add a primary key column to an existing table");
     }
     
-    TableSchema schema;
-    schema.table_name = name;
-    schema.columns = columns;
-    
-    auto table = std::make_shared<Table>(name, schema);
+    Column added = column;
+    added.id = schema_.next_column_id++;
+    schema_.columns.push_back(added);
+    schema_.version++;
+    update_layout();
     
-    if (!table->save_to_disk(db_root_ / "data")) {
-        std::cerr << "Error: Failed to save table to disk\n";
-        return false;
+    // Stored rows are adapted on read; rows already decoded in memory
+    // take the default now
+    for (auto& record : records_) {
+        record.values.push_back(added.default_value);
+    }
+    for (auto& [row_id, version] : versions_) {
+        version.values.push_back(added.default_value);
     }
+    zones_.add_column(added.type, added.default_value);
     
-    tables_[name] = table;
+    // Every row's contents changed, so every block is rehashed
+    block_hashes_.clear();
+    rows_dirty_ = true;
     
-    std::cout << "Table '" << name << "' created successfully\n";
-    return true;
-}
-
-bool Database::table_exists(const std::string& name) const {
-    return tables_.find(name) != tables_.end();
+    // A .data file without a slot count cannot describe the new layout
+    if (legacy_data_) {
+        base_dirty_ = true;
+    }
+    return Status::ok();
 }
 
-std::shared_ptr<Table> Database::get_table(const std::string& name) {
-    if (!table_exists(name)) {
-        // Try to load from disk
-        auto table = Table::load_from_disk(db_root_ / "data", name);
-        if (table) {
-            tables_[name] = std::move(table);
-        }
+Status Table::drop_column(const std::string& name, const std::filesystem::path& data_dir) {
+    auto col = schema_.find_column(name);
+    if (!col) {
+        return Status::error("Unknown column '" + name + "'");
+    }
+    if (schema_.columns[*col].primary_key) {
+        return Status::error("Cannot drop primary key column '" + name + "'");
+    }
+    if (schema_.columns.size() == 1) {
+        return Status::error("Cannot drop the only column of table '" + name_ + "'");
     }
     
-    auto it = tables_.find(name);
-    return (it != tables_.end()) ? it->second : nullptr;
-}
-
-bool Database::insert_into(const std::string& table_name, const Record& record) {
-    auto table = get_table(table_name);
-    if (!table) {
-        std::cerr << "Error: Table '" << table_name << "' does not exist\n";
-        return false;
+    if (indexes_.erase(name) > 0) {
+        std::error_code ec;
+        std::filesystem::remove(get_index_path(data_dir, name_, name), ec);
     }
     
-    if (!table->insert(record)) {
-        return false;
+    schema_.columns.erase(schema_.columns.begin() + *col);
+    schema_.version++;
+    update_layout();
+    
+    for (auto& record : records_) {
+        record.values.erase(record.values.begin() + *col);
+    }
+    for (auto& [row_id, version] : versions_) {
+        version.values.erase(version.values.begin() + *col);
     }
+    zones_.drop_column(*col);
     
-    if (!table->save_to_disk(db_root_ / "data")) {
-        std::cerr << "Error: Failed to save table to disk\n";
-        return false;
+    // Dictionaries are keyed by position, which shifts down
+    std::unordered_map<size_t, DictionaryColumn> dictionaries;
+    for (auto& [column, dictionary] : dictionaries_) {
+        if (column != *col) {
+            dictionaries.emplace(column > *col ? column - 1 : column, std::move(dictionary));
+        }
     }
+    dictionaries_ = std::move(dictionaries);
     
-    return true;
+    block_hashes_.clear();
+    rows_dirty_ = true;
+    if (legacy_data_) {
+        base_dirty_ = true;
+    }
+    return Status::ok();
 }
 
-std::vector<Record> Database::select_from(const std::string& table_name) {
-    auto table = get_table(table_name);
-    if (!table) {
-        std::cerr << "Error: Table '" << table_name << "' does not exist\n";
-        return {};
+const DictionaryColumn* Table::get_dictionary(size_t column) const {
+    if (!versions_.empty()) {
+        return nullptr;
     }
+    auto it = dictionaries_.find(column);
+    return it != dictionaries_.end() ? &it->second : nullptr;
+}
+
+void Table::choose_dictionaries() {
+    const size_t rows = records_.size();
     
-    return table->select_all();
+    for (size_t col = 0; col < schema_.columns.size(); ++col) {
+        if (schema_.columns[col].type != DataType::TEXT) continue;
+        
+        auto it = dictionaries_.find(col);
+        if (it != dictionaries_.end()) {
+            if (!DictionaryColumn::worth_encoding(rows, it->second.distinct())) {
+                dictionaries_.erase(it);
+            }
+            continue;
+        }
+        
+        if (!DictionaryColumn::worth_encoding(rows, 0)) continue;
+        
+        // Probe a prefix of the column before encoding all of it
+        DictionaryColumn dictionary;
+        size_t sample = std::min(rows, DictionaryColumn::kSampleRows);
+        for (size_t row = 0; row < sample; ++row) {
+            dictionary.encode(records_[row].values[col]);
+        }
+        if (!DictionaryColumn::worth_encoding(sample, dictionary.distinct())) continue;
+        
+        dictionary = DictionaryColumn();
+        for (const auto& record : records_) {
+            dictionary.append(record.values[col]);
+        }
+        
+        if (DictionaryColumn::worth_encoding(rows, dictionary.distinct())) {
+            dictionaries_.emplace(col, std::move(dictionary));
+        }
+    }
 }
 
-std::string Database::commit(const std::string& message) {
-    if (!git_store_) {
-        std::cerr << "Error: Git store not initialized\n";
-        return "";
+void Table::rebuild_zones() {
+    std::vector<DataType> types;
+    for (const auto& col : schema_.columns) {
+        types.push_back(col.type);
     }
     
-    std::string commit_hash = git_store_->commit(message, db_root_ / "data");
-    
-    if (!commit_hash.empty()) {
-        std::cout << "Committed successfully\n";
-        std::cout << "Commit hash: " << commit_hash << "\n";
+    // Blocks are positional, so deleted rows keep their place
+    zones_ = ZoneMap(types);
+    Record scratch;
+    for (size_t row_id = 0; row_id < row_count(); ++row_id) {
+        const Record* record = row_at(row_id, scratch);
+        if (!record) record = base_row_at(row_id, scratch);
+        if (record) {
+            zones_.add(record->values);
+        }
     }
-    
-    return commit_hash;
 }
 
-std::vector<Commit> Database::get_log() {
-    if (!git_store_) {
-        return {};
+std::string Table::key_of(const std::vector<std::string>& values) const {
+    std::string key;
+    for (size_t i = 0; i < key_columns_.size(); ++i) {
+        size_t col = key_columns_[i];
+        if (i > 0) key += '\x1f';
+        key += TypedValue::parse(schema_.columns[col].type, values[col]).to_string();
     }
-    
-    return git_store_->get_log();
+    return key;
 }
 
-bool Database::checkout(const std::string& commit_hash) {
-    if (!git_store_) {
-        std::cerr << "Error: Git store not initialized\n";
+bool Table::key_exists(const std::string& key) const {
+    if (!key_filter_->may_contain(key)) {
+        Metrics::instance().add(Counter::BLOOM_NEGATIVES);
         return false;
     }
     
-    if (git_store_->checkout(commit_hash, db_root_ / "data")) {
-        // Reload tables from disk
-        tables_.clear();
-        load_tables();
-        
-        std::cout << "Checked out commit " << commit_hash << "\n";
-        return true;
+    // Possible hit: confirm through an index on the key, or a scan
+    bool found = false;
+    auto index = key_columns_.size() == 1
+        ? indexes_.find(schema_.columns[key_columns_[0]].name)
+        : indexes_.end();
+    
+    if (index != indexes_.end()) {
+        // Index entries may be stale after deletes and updates
+        auto rows = index->second->lookup(CompareOp::EQ,
+            TypedValue::parse(schema_.columns[key_columns_[0]].type, key));
+        Record scratch;
+        for (size_t i = 0; rows && i < rows->size() && !found; ++i) {
+            const Record* record = row_at((*rows)[i], scratch);
+            found = record && key_of(record->values) == key;
+        }
+    } else {
+        Record scratch;
+        for (size_t row_id = 0; row_id < row_count() && !found; ++row_id) {
+            const Record* record = row_at(row_id, scratch);
+            found = record && key_of(record->values) == key;
+        }
     }
     
-    return false;
+    if (!found) {
+        Metrics::instance().add(Counter::BLOOM_FALSE_POSITIVES);
+    }
+    return found;
+}
+
+void Table::rebuild_key_filter() {
+    key_filter_ = std::make_unique<BloomFilter>(row_count() * 2);
+    filter_dirty_ = true;
+    
+    // One key per row id, so the filter is current while it holds at
+    // least row_count() keys
+    Record scratch;
+    for (size_t row_id = 0; row_id < row_count(); ++row_id) {
+        const Record* record = row_at(row_id, scratch);
+        if (!record) record = base_row_at(row_id, scratch);
+        if (record) {
+            key_filter_->add(key_of(record->values));
+        }
+    }
+}
+
+std::vector<Record> Table::select_all() const {
+    if (!paged_ && deleted_count_ == 0 && versions_.empty()) {
+        return records_;
+    }
+    
+    std::vector<Record> result;
+    result.reserve(live_row_count());
+    Record scratch;
+    for (size_t row_id = 0; row_id < row_count(); ++row_id) {
+        if (const Record* record = row_at(row_id, scratch)) {
+            result.push_back(*record);
+        }
+    }
+    return result;
+}
+
+Status Table::select_where(const std::vector<Predicate>& predicates, std::vector<Record>* rows) const {
+    ScanOptions options;
+    options.predicates = predicates;
+    
+    std::unique_ptr<TableCursor> cursor;
+    if (Status status = open_cursor(options, &cursor); !status) {
+        return status;
+    }
+    
+    std::vector<Record> batch;
+    rows->clear();
+    while (cursor->next_batch(batch)) {
+        rows->insert(rows->end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    }
+    return cursor->status();
+}
+
+Status Table::open_cursor(const ScanOptions& options, std::unique_ptr<TableCursor>* result) const {
+    std::vector<BoundPredicate> bound;
+    for (const auto& pred : options.predicates) {
+        auto col = schema_.find_column(pred.column);
+        if (!col) {
+            return Status::error("Unknown column '" + pred.column + "'");
+        }
+        bound.push_back({*col, pred.op, TypedValue::parse(schema_.columns[*col].type, pred.value)});
+    }
+    
+    std::unique_ptr<TableCursor> cursor(new TableCursor(*this, bound, options.offset, options.limit));
+    
+    // Equality on the whole primary key: a Bloom filter miss means no rows
+    if (key_filter_) {
+        std::vector<std::string> key_values(schema_.columns.size());
+        size_t bound_keys = 0;
+        for (size_t col : key_columns_) {
+            for (const auto& bp : bound) {
+                if (bp.column == col && bp.op == CompareOp::EQ) {
+                    key_values[col] = bp.operand.to_string();
+                    bound_keys++;
+                    break;
+                }
+            }
+        }
+        
+        if (bound_keys == key_columns_.size() && !key_filter_->may_contain(key_of(key_values))) {
+            Metrics::instance().add(Counter::BLOOM_NEGATIVES);
+            cursor->row_ids_ = std::vector<size_t>();
+            *result = std::move(cursor);
+            return Status::ok();
+        }
+    }
+    
+    // Narrow the candidate rows with the first indexed predicate
+    for (const auto& bp : bound) {
+        auto it = indexes_.find(schema_.columns[bp.column].name);
+        if (it == indexes_.end()) continue;
+        
+        cursor->row_ids_ = it->second->lookup(bp.op, bp.operand);
+        if (cursor->row_ids_) {
+            Metrics::instance().add(Counter::INDEX_LOOKUPS);
+            break;
+        }
+    }
+    
+    // Restrict the scan to a range of row ids
+    if (cursor->row_ids_) {
+        auto& ids = *cursor->row_ids_;
+        ids.erase(std::remove_if(ids.begin(), ids.end(), [&](size_t id) {
+            return id < options.row_begin || (options.row_end && id >= *options.row_end);
+        }), ids.end());
+    } else {
+        cursor->position_ = options.row_begin;
+        cursor->row_end_ = options.row_end;
+    }
+    
+    *result = std::move(cursor);
+    return Status::ok();
+}
+
+// TableCursor Implementation
+TableCursor::TableCursor(const Table& table, std::vector<BoundPredicate> predicates,
+                         size_t offset, std::optional<size_t> limit)
+    : table_(table), predicates_(std::move(predicates)), offset_(offset), limit_(limit) {
+    coded_.resize(predicates_.size());
+    for (size_t i = 0; i < predicates_.size(); ++i) {
+        const auto& bp = predicates_[i];
+        if (bp.op != CompareOp::EQ && bp.op != CompareOp::NE) continue;
+        
+        if (const DictionaryColumn* dictionary = table_.get_dictionary(bp.column)) {
+            coded_[i].dictionary = dictionary;
+            coded_[i].code = dictionary->find(bp.operand.text_value);
+        }
+    }
+}
+
+void TableCursor::request_codes(const std::vector<size_t>& columns) {
+    code_columns_.clear();
+    for (size_t column : columns) {
+        code_columns_.push_back(table_.get_dictionary(column));
+    }
+    batch_codes_.assign(columns.size(), {});
+}
+
+const std::vector<uint32_t>* TableCursor::batch_codes(size_t i) const {
+    return code_columns_[i] ? &batch_codes_[i] : nullptr;
+}
+
+bool TableCursor::matches(size_t row_id, const Record& record) const {
+    for (size_t i = 0; i < predicates_.size(); ++i) {
+        const auto& bp = predicates_[i];
+        const auto& coded = coded_[i];
+        
+        if (coded.dictionary) {
+            bool equal = coded.code && coded.dictionary->code_at(row_id) == *coded.code;
+            if (equal != (bp.op == CompareOp::EQ)) return false;
+        } else if (!bp.matches(record.values[bp.column])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TableCursor::block_may_match(size_t block) const {
+    for (const auto& bp : predicates_) {
+        if (!table_.zones_.may_match(block, bp)) return false;
+    }
+    return true;
+}
+
+bool TableCursor::next_batch(std::vector<Record>& batch, size_t batch_size) {
+    batch.clear();
+    batch_rows_.clear();
+    for (auto& codes : batch_codes_) {
+        codes.clear();
+    }
+    
+    const size_t rows = table_.row_count();
+    const size_t end = row_ids_ ? row_ids_->size() : std::min(rows, row_end_.value_or(rows));
+    size_t scanned = 0;
+    Record scratch;
+    
+    while (batch.size() < batch_size && position_ < end) {
+        if (limit_ && returned_ >= *limit_) {
+            position_ = end;
+            break;
+        }
+        
+        // Sequential scans skip whole blocks the zone map rules out
+        if (!row_ids_ && !predicates_.empty() && position_ % ZoneMap::kBlockRows == 0 &&
+            !block_may_match(position_ / ZoneMap::kBlockRows)) {
+            position_ = std::min(end, position_ + ZoneMap::kBlockRows);
+            Metrics::instance().add(Counter::BLOCKS_SKIPPED);
+            continue;
+        }
+        
+        size_t row_id = row_ids_ ? (*row_ids_)[position_] : position_;
+        position_++;
+        
+        const Record* record = table_.row_at(row_id, scratch);
+        if (!record) {
+            if (table_.is_deleted(row_id)) continue;
+            status_ = Status::error("Failed to read row " + std::to_string(row_id) +
+                                    " of table '" + table_.name_ + "'");
+            position_ = end;
+            break;
+        }
+        scanned++;
+        
+        if (!matches(row_id, *record)) continue;
+        
+        if (skipped_ < offset_) {
+            skipped_++;
+            continue;
+        }
+        
+        batch.push_back(*record);
+        if (track_rows_) {
+            batch_rows_.push_back(row_id);
+        }
+        for (size_t i = 0; i < code_columns_.size(); ++i) {
+            if (code_columns_[i]) {
+                batch_codes_[i].push_back(code_columns_[i]->code_at(row_id));
+            }
+        }
+        returned_++;
+    }
+    
+    Metrics::instance().add(Counter::ROWS_SCANNED, scanned);
+    Metrics::instance().add(Counter::ROWS_RETURNED, batch.size());
+    return !batch.empty();
+}
+
+bool TableCursor::next(Record& record) {
+    if (buffer_pos_ >= buffer_.size()) {
+        buffer_pos_ = 0;
+        if (!next_batch(buffer_)) {
+            return false;
+        }
+    }
+    
+    record = std::move(buffer_[buffer_pos_++]);
+    return true;
+}
+
+Status Table::create_index(const std::string& column) {
+    auto col = schema_.find_column(column);
+    if (!col) {
+        return Status::error("Unknown column '" + column + "'");
+    }
+    
+    if (has_index(column)) {
+        return Status::error("Index on '" + name_ + "." + column + "' already exists");
+    }
+    
+    auto index = std::make_unique<SecondaryIndex>(column, schema_.columns[*col].type);
+    Record scratch;
+    for (size_t row_id = 0; row_id < row_count(); ++row_id) {
+        if (const Record* record = row_at(row_id, scratch)) {
+            index->insert(record->values[*col], row_id);
+        }
+    }
+    
+    indexes_[column] = std::move(index);
+    base_dirty_ = true;
+    return Status::ok();
+}
+
+std::vector<std::string> Table::file_names() const {
+    std::vector<std::string> files;
+    if (schema_.storage == StorageType::PAGED) {
+        files.push_back(name_ + ".pages");
+        files.push_back(name_ + ".pagedir");
+    } else {
+        files.push_back(name_ + ".data");
+    }
+    
+    files.push_back(name_ + ".zones");
+    files.push_back(name_ + ".rows");
+    if (key_filter_) {
+        files.push_back(name_ + ".bloom");
+    }
+    if (deleted_count_ > 0 || !versions_.empty()) {
+        files.push_back(name_ + ".delta");
+    }
+    
+    std::vector<std::string> indexed;
+    for (const auto& [column, index] : indexes_) {
+        indexed.push_back(column);
+    }
+    std::sort(indexed.begin(), indexed.end());
+    for (const auto& column : indexed) {
+        files.push_back(get_index_path("", name_, column).string());
+    }
+    
+    return files;
+}
+
+bool Table::has_index(const std::string& column) const {
+    return indexes_.find(column) != indexes_.end();
+}
+
+std::filesystem::path Table::get_data_path(const std::filesystem::path& data_dir) const {
+    return data_dir / (name_ + ".data");
+}
+
+std::filesystem::path Table::get_zones_path(const std::filesystem::path& data_dir) const {
+    return data_dir / (name_ + ".zones");
+}
+
+std::filesystem::path Table::get_bloom_path(const std::filesystem::path& data_dir) const {
+    return data_dir / (name_ + ".bloom");
+}
+
+std::filesystem::path Table::get_delta_path(const std::filesystem::path& data_dir) const {
+    return data_dir / (name_ + ".delta");
+}
+
+std::filesystem::path Table::get_rows_path(const std::filesystem::path& data_dir) const {
+    return data_dir / (name_ + ".rows");
+}
+
+std::filesystem::path Table::get_compaction_path(const std::filesystem::path& data_dir) const {
+    return data_dir / (name_ + ".compact");
+}
+
+std::filesystem::path Table::get_index_path(
+    const std::filesystem::path& data_dir,
+    const std::string& table_name,
+    const std::string& column
+) {
+    return data_dir / (table_name + "." + column + ".idx");
+}
+
+bool Table::write_data_file(const std::filesystem::path& path) const {
+    std::ofstream data_file(path);
+    if (!data_file.is_open()) return false;
+    
+    // Rows are written in the stored layout: one value per column id,
+    // empty where a column was dropped
+    const size_t slots = schema_.next_column_id;
+    std::vector<std::optional<size_t>> column_at(slots);
+    for (size_t col = 0; col < schema_.columns.size(); ++col) {
+        column_at[schema_.columns[col].id] = col;
+    }
+    
+    // Header: row count, slot count, then the dictionary-encoded slots
+    std::vector<size_t> dict_slots;
+    std::vector<const DictionaryColumn*> encoded(slots, nullptr);
+    for (const auto& [column, dictionary] : dictionaries_) {
+        size_t slot = schema_.columns[column].id;
+        dict_slots.push_back(slot);
+        encoded[slot] = &dictionary;
+    }
+    std::sort(dict_slots.begin(), dict_slots.end());
+    
+    data_file << records_.size() << " slots=" << slots;
+    for (size_t i = 0; i < dict_slots.size(); ++i) {
+        data_file << (i == 0 ? " dict=" : ",") << dict_slots[i];
+    }
+    data_file << "\n";
+    
+    for (size_t slot : dict_slots) {
+        const auto& values = encoded[slot]->values();
+        data_file << values.size() << "\n";
+        for (const auto& value : values) {
+            data_file << value << "\n";
+        }
+    }
+    
+    for (size_t row = 0; row < records_.size(); ++row) {
+        const auto& record = records_[row];
+        for (size_t slot = 0; slot < slots; ++slot) {
+            if (encoded[slot]) {
+                data_file << encoded[slot]->code_at(row);
+            } else if (column_at[slot]) {
+                data_file << record.values[*column_at[slot]];
+            }
+            if (slot < slots - 1) {
+                data_file << ",";
+            }
+        }
+        data_file << "\n";
+    }
+    
+    Metrics::instance().add(Counter::BYTES_WRITTEN, static_cast<uint64_t>(data_file.tellp()));
+    return static_cast<bool>(data_file.flush());
+}
+
+namespace {
+
+constexpr char kDeltaMagic[8] = {'V', 'S', 'D', 'B', 'D', 'L', 'T', '1'};
+constexpr char kRowsMagic[8] = {'V', 'S', 'D', 'B', 'R', 'O', 'W', '1'};
+
+} // namespace
+
+bool Table::write_delta_file(const std::filesystem::path& path) const {
+    // Row count, tombstoned row ids, then each version as row id + values
+    ByteEncoder out;
+    out.u64(row_count());
+    
+    out.u64(deleted_count_);
+    for (size_t row_id = 0; row_id < deleted_.size(); ++row_id) {
+        if (deleted_[row_id]) out.u64(row_id);
+    }
+    
+    std::vector<size_t> updated;
+    updated.reserve(versions_.size());
+    for (const auto& [row_id, version] : versions_) {
+        updated.push_back(row_id);
+    }
+    std::sort(updated.begin(), updated.end());
+    
+    out.u64(updated.size());
+    std::vector<std::string> stored;
+    for (size_t row_id : updated) {
+        const auto& values = stored_row(versions_.at(row_id).values, stored);
+        out.u64(row_id);
+        out.u32(static_cast<uint32_t>(values.size()));
+        for (const auto& value : values) {
+            out.str(value);
+        }
+    }
+    
+    const std::string& payload = out.bytes();
+    uint64_t sum = fnv1a_checksum(payload.data(), payload.size());
+    
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(kDeltaMagic, sizeof(kDeltaMagic));
+    file.write(payload.data(), payload.size());
+    file.write(reinterpret_cast<const char*>(&sum), sizeof(sum));
+    
+    Metrics::instance().add(Counter::BYTES_WRITTEN, sizeof(kDeltaMagic) + payload.size() + sizeof(sum));
+    return static_cast<bool>(file.flush());
+}
+
+bool Table::load_delta_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string bytes = buffer.str();
+    
+    if (bytes.size() < sizeof(kDeltaMagic) + sizeof(uint64_t) ||
+        std::memcmp(bytes.data(), kDeltaMagic, sizeof(kDeltaMagic)) != 0) {
+        return false;
+    }
+    
+    const char* payload = bytes.data() + sizeof(kDeltaMagic);
+    size_t payload_size = bytes.size() - sizeof(kDeltaMagic) - sizeof(uint64_t);
+    uint64_t stored = 0;
+    std::memcpy(&stored, payload + payload_size, sizeof(stored));
+    if (stored != fnv1a_checksum(payload, payload_size)) {
+        return false;
+    }
+    
+    // Rows appended since the delta was written keep the ids valid; a
+    // delta covering more rows than exist predates a compaction
+    ByteDecoder in(payload, payload_size);
+    const size_t rows = row_count();
+    if (in.u64() > rows) {
+        return false;
+    }
+    
+    std::vector<bool> deleted(rows, false);
+    size_t deleted_count = 0;
+    uint64_t tombstones = in.u64();
+    for (uint64_t i = 0; i < tombstones && in.ok(); ++i) {
+        uint64_t row_id = in.u64();
+        if (row_id >= rows || deleted[row_id]) return false;
+        deleted[row_id] = true;
+        deleted_count++;
+    }
+    
+    std::unordered_map<size_t, Record> versions;
+    uint64_t updated = in.u64();
+    for (uint64_t i = 0; i < updated && in.ok(); ++i) {
+        uint64_t row_id = in.u64();
+        uint32_t columns = in.u32();
+        if (row_id >= rows || columns > schema_.next_column_id) return false;
+        
+        Record version;
+        version.values.reserve(columns);
+        for (uint32_t c = 0; c < columns; ++c) {
+            version.values.push_back(in.str());
+        }
+        adapt_row(version.values);
+        versions[row_id] = std::move(version);
+    }
+    
+    if (!in.ok() || !in.at_end()) {
+        return false;
+    }
+    
+    deleted_ = std::move(deleted);
+    deleted_count_ = deleted_count;
+    versions_ = std::move(versions);
+    return true;
+}
+
+bool Table::write_rows_file(const std::filesystem::path& path) const {
+    // Row count, then one hash per block; stale blocks are empty
+    ByteEncoder out;
+    out.u64(row_count());
+    out.u64(block_hashes_.size());
+    for (const auto& hash : block_hashes_) {
+        out.str(hash);
+    }
+    
+    const std::string& payload = out.bytes();
+    uint64_t sum = fnv1a_checksum(payload.data(), payload.size());
+    
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(kRowsMagic, sizeof(kRowsMagic));
+    file.write(payload.data(), payload.size());
+    file.write(reinterpret_cast<const char*>(&sum), sizeof(sum));
+    
+    Metrics::instance().add(Counter::BYTES_WRITTEN, sizeof(kRowsMagic) + payload.size() + sizeof(sum));
+    return static_cast<bool>(file.flush());
+}
+
+void Table::load_rows_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return;
+    
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string bytes = buffer.str();
+    
+    if (bytes.size() < sizeof(kRowsMagic) + sizeof(uint64_t) ||
+        std::memcmp(bytes.data(), kRowsMagic, sizeof(kRowsMagic)) != 0) {
+        return;
+    }
+    
+    const char* payload = bytes.data() + sizeof(kRowsMagic);
+    size_t payload_size = bytes.size() - sizeof(kRowsMagic) - sizeof(uint64_t);
+    uint64_t stored = 0;
+    std::memcpy(&stored, payload + payload_size, sizeof(stored));
+    if (stored != fnv1a_checksum(payload, payload_size)) {
+        return;
+    }
+    
+    ByteDecoder in(payload, payload_size);
+    uint64_t rows = in.u64();
+    uint64_t blocks = in.u64();
+    std::vector<std::string> hashes;
+    for (uint64_t i = 0; i < blocks && in.ok(); ++i) {
+        hashes.push_back(in.str());
+    }
+    if (!in.ok() || !in.at_end()) {
+        return;
+    }
+    
+    // The file is written before the rows, so a count that differs means
+    // rows were added or dropped since; only full blocks below both
+    // counts are still trusted
+    if (rows != row_count()) {
+        hashes.resize(std::min<uint64_t>(rows, row_count()) / ZoneMap::kBlockRows);
+    }
+    block_hashes_ = std::move(hashes);
+}
+
+bool Table::save_to_disk(const std::filesystem::path& data_dir) {
+    ScopedTimer timer(Timer::TABLE_SAVE);
+    timer.span().annotate(name_);
+    
+    if (needs_compaction() && !compact(data_dir)) {
+        return false;
+    }
+    
+    // After a compaction every file is staged and swapped in at the end
+    std::vector<std::string> staged;
+    auto target = [&](const std::filesystem::path& path) {
+        if (!compaction_pending_) return path;
+        staged.push_back(path.filename().string());
+        std::filesystem::path staged_path = path;
+        return staged_path += ".compact";
+    };
+    
+    // Block hashes go first: blocks about to change are already marked
+    // stale on disk if the rows below are left half written
+    if (rows_dirty_ &&
+        !replace_file(target(get_rows_path(data_dir)), [&](const auto& tmp) { return write_rows_file(tmp); })) {
+        return false;
+    }
+    
+    // Every file is replaced whole, so a snapshot holding links to the
+    // previous files is unaffected. Deletes and updates alone leave the
+    // base rows and indexes untouched and rewrite only the small files.
+    if (schema_.storage == StorageType::PAGED) {
+        if (!paged_ && !open_paged_store(data_dir)) {
+            return false;
+        }
+        if (!paged_->flush()) {
+            return false;
+        }
+        if (compaction_pending_) {
+            staged.push_back(name_ + ".pages");
+            staged.push_back(name_ + ".pagedir");
+        }
+    } else if (base_dirty_) {
+        choose_dictionaries();
+        
+        if (!replace_file(target(get_data_path(data_dir)), [&](const auto& tmp) { return write_data_file(tmp); })) {
+            return false;
+        }
+    }
+    
+    if (!replace_file(target(get_zones_path(data_dir)), [&](const auto& tmp) { return zones_.save_to_file(tmp); })) {
+        return false;
+    }
+    
+    // Deletes leave the filter as it was
+    if (key_filter_ && filter_dirty_ &&
+        !replace_file(target(get_bloom_path(data_dir)), [&](const auto& tmp) { return key_filter_->save_to_file(tmp); })) {
+        return false;
+    }
+    
+    // Save secondary indexes
+    for (const auto& [column, index] : indexes_) {
+        if (!base_dirty_) break;
+        auto path = target(get_index_path(data_dir, name_, column));
+        if (!replace_file(path, [&](const auto& tmp) { return index->save_to_file(tmp); })) {
+            return false;
+        }
+    }
+    
+    if (compaction_pending_) {
+        // A compacted table has no delta
+        if (!publish_compaction(data_dir, staged)) {
+            return false;
+        }
+    } else if (base_dirty_ || delta_dirty_) {
+        if (deleted_count_ > 0 || !versions_.empty()) {
+            if (!replace_file(get_delta_path(data_dir), [&](const auto& tmp) { return write_delta_file(tmp); })) {
+                return false;
+            }
+        } else {
+            std::error_code ec;
+            std::filesystem::remove(get_delta_path(data_dir), ec);
+        }
+    }
+    
+    base_dirty_ = false;
+    delta_dirty_ = false;
+    rows_dirty_ = false;
+    filter_dirty_ = false;
+    return true;
+}
+
+bool Table::publish_compaction(const std::filesystem::path& data_dir, const std::vector<std::string>& staged) {
+    // One line per file: "+<file>" to move <file>.compact over it,
+    // "-<file>" to remove it
+    bool written = replace_file(get_compaction_path(data_dir), [&](const std::filesystem::path& tmp_path) {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out.is_open()) return false;
+        for (const auto& file : staged) {
+            out << "+" << file << "\n";
+        }
+        out << "-" << get_delta_path(data_dir).filename().string() << "\n";
+        return static_cast<bool>(out.flush());
+    });
+    if (!written) {
+        return false;
+    }
+    
+    // The staged pages are reopened under their final names
+    const bool paged = paged_ != nullptr;
+    paged_.reset();
+    if (!finish_compaction(data_dir) || (paged && !open_paged_store(data_dir))) {
+        return false;
+    }
+    compaction_pending_ = false;
+    return true;
+}
+
+bool Table::finish_compaction(const std::filesystem::path& data_dir) {
+    std::filesystem::path list = get_compaction_path(data_dir);
+    std::ifstream in(list);
+    std::error_code ec;
+    
+    if (!in.is_open()) {
+        // Interrupted before the swap: the old files are intact
+        std::vector<std::filesystem::path> files = {
+            get_data_path(data_dir), get_zones_path(data_dir), get_bloom_path(data_dir),
+            get_rows_path(data_dir), data_dir / (name_ + ".pages"), data_dir / (name_ + ".pagedir")
+        };
+        for (const auto& col : schema_.columns) {
+            files.push_back(get_index_path(data_dir, name_, col.name));
+        }
+        for (auto& file : files) {
+            std::filesystem::remove(file += ".compact", ec);
+        }
+        return true;
+    }
+    
+    // Each step can be repeated, so an interrupted swap is finished later
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.size() < 2) continue;
+        std::filesystem::path file = data_dir / line.substr(1);
+        
+        if (line[0] == '+') {
+            std::filesystem::path staged = file;
+            staged += ".compact";
+            if (!std::filesystem::exists(staged)) continue;
+            std::filesystem::rename(staged, file, ec);
+            if (ec) return false;
+        } else if (line[0] == '-') {
+            std::filesystem::remove(file, ec);
+            if (ec) return false;
+        }
+    }
+    
+    in.close();
+    std::filesystem::remove(list, ec);
+    return !ec;
+}
+
+std::unique_ptr<Table> Table::load_from_disk(
+    const std::filesystem::path& data_dir,
+    const TableSchema& schema,
+    bool reserve_rows
+) {
+    ScopedTimer timer(Timer::TABLE_LOAD);
+    timer.span().annotate(schema.table_name);
+    
+    const std::string& table_name = schema.table_name;
+    std::filesystem::path data_path = data_dir / (table_name + ".data");
+    
+    auto table = std::make_unique<Table>(table_name, schema);
+    if (!table->finish_compaction(data_dir)) {
+        return nullptr;
+    }
+    
+    if (schema.storage == StorageType::PAGED) {
+        // Only the page directory is read; rows stay on disk
+        if (!table->open_paged_store(data_dir)) {
+            return nullptr;
+        }
+    } else if (std::filesystem::exists(data_path)) {
+        std::ifstream data_file(data_path);
+        
+        // Header: row count, optionally followed by "slots=<n>" and
+        // "dict=<slot>,<slot>". Files without a slot count were written
+        // before any schema change, with one slot per column.
+        std::string header;
+        std::getline(data_file, header);
+        std::istringstream header_ss(header);
+        
+        size_t num_records = 0;
+        std::string attr;
+        std::vector<size_t> dict_slots;
+        std::optional<size_t> slot_count;
+        header_ss >> num_records;
+        
+        while (header_ss >> attr) {
+            if (attr.rfind("slots=", 0) == 0) {
+                slot_count = std::stoul(attr.substr(6));
+            }
+            if (attr.rfind("dict=", 0) != 0) continue;
+            std::stringstream cols(attr.substr(5));
+            std::string col;
+            while (std::getline(cols, col, ',')) {
+                dict_slots.push_back(std::stoul(col));
+            }
+        }
+        
+        table->legacy_data_ = !slot_count;
+        const size_t num_columns = slot_count.value_or(schema.columns.size());
+        if (reserve_rows) {
+            table->records_.reserve(num_records);
+        }
+        
+        // Dictionaries are read by slot and re-keyed by column once the
+        // rows are decoded
+        std::unordered_map<size_t, DictionaryColumn> dictionaries;
+        std::vector<DictionaryColumn*> encoded(num_columns, nullptr);
+        for (size_t column : dict_slots) {
+            if (column >= num_columns) continue;
+            
+            size_t num_values = 0;
+            data_file >> num_values;
+            data_file.ignore();
+            
+            DictionaryColumn& dictionary = dictionaries[column];
+            if (reserve_rows) {
+                dictionary.reserve(num_records);
+            }
+            for (size_t i = 0; i < num_values; ++i) {
+                std::string value;
+                std::getline(data_file, value);
+                dictionary.encode(value);
+            }
+            encoded[column] = &dictionary;
+        }
+        
+        std::string line;
+        for (size_t i = 0; i < num_records; ++i) {
+            std::getline(data_file, line);
+            
+            Record record;
+            record.values.reserve(num_columns);
+            
+            size_t start = 0;
+            while (start < line.size()) {
+                size_t comma = line.find(',', start);
+                if (comma == std::string::npos) comma = line.size();
+                std::string value = line.substr(start, comma - start);
+                start = comma + 1;
+                
+                size_t col = record.values.size();
+                if (col < encoded.size() && encoded[col]) {
+                    uint32_t code = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+                    if (code >= encoded[col]->distinct()) {
+                        code = encoded[col]->encode("");
+                    }
+                    encoded[col]->append_code(code);
+                    value = encoded[col]->decode(code);
+                }
+                record.values.push_back(std::move(value));
+            }
+            
+            // Trailing empty values produce no token
+            while (record.values.size() < num_columns) {
+                size_t col = record.values.size();
+                if (encoded[col]) encoded[col]->append("");
+                record.values.emplace_back();
+            }
+            
+            table->adapt_row(record.values);
+            table->records_.push_back(std::move(record));
+        }
+        
+        for (size_t col = 0; col < schema.columns.size(); ++col) {
+            auto it = dictionaries.find(table->schema_.columns[col].id);
+            if (it != dictionaries.end()) {
+                table->dictionaries_.emplace(col, std::move(it->second));
+            }
+        }
+        
+        Metrics::instance().add(Counter::ROWS_LOADED, num_records);
+        Metrics::instance().add(Counter::BYTES_READ, std::filesystem::file_size(data_path));
+    }
+    
+    // Tombstones and row versions; an unreadable delta is left out,
+    // which exposes the base rows
+    bool rebuilt = false;
+    auto delta_path = table->get_delta_path(data_dir);
+    if (std::filesystem::exists(delta_path) && !table->load_delta_file(delta_path)) {
+        rebuilt = true;
+    }
+    
+    // Block hashes; missing or stale ones are recomputed on the next
+    // commit. Without the delta the rows they describe are gone.
+    auto rows_path = table->get_rows_path(data_dir);
+    if (!rebuilt) {
+        table->load_rows_file(rows_path);
+    }
+    
+    // Zone map; recomputed if missing or stale
+    auto zones = ZoneMap::load_from_file(table->get_zones_path(data_dir), table->zones_.types());
+    if (zones && zones->row_count() == table->row_count()) {
+        table->zones_ = std::move(*zones);
+    } else {
+        table->rebuild_zones();
+        rebuilt = true;
+    }
+    
+    // Primary key filter; recomputed if missing or stale. Updated keys
+    // are added on top of one key per row id.
+    if (table->key_filter_) {
+        auto filter = BloomFilter::load_from_file(table->get_bloom_path(data_dir));
+        if (filter && filter->key_count() >= table->row_count()) {
+            table->key_filter_ = std::move(filter);
+        } else {
+            table->rebuild_key_filter();
+            rebuilt = true;
+        }
+    }
+    
+    // Load secondary indexes
+    for (const auto& col : table->schema_.columns) {
+        auto index_path = get_index_path(data_dir, table_name, col.name);
+        if (!std::filesystem::exists(index_path)) continue;
+        
+        auto index = SecondaryIndex::load_from_file(index_path);
+        if (index && index->get_type() == col.type) {
+            // Index files cover the base rows; add the updated values
+            size_t column = *schema.find_column(col.name);
+            for (const auto& [row_id, version] : table->versions_) {
+                index->insert(version.values[column], row_id);
+            }
+            table->indexes_[col.name] = std::move(index);
+        } else {
+            // Unreadable index file: rebuild it from the rows
+            (void)table->create_index(col.name);
+            rebuilt = true;
+        }
+    }
+    
+    // Anything recomputed is written back on the next save
+    table->base_dirty_ = rebuilt;
+    table->delta_dirty_ = false;
+    table->filter_dirty_ = rebuilt;
+    table->rows_dirty_ = rebuilt || !std::filesystem::exists(rows_path);
+    
+    Metrics::instance().add(Counter::TABLES_LOADED);
+    return table;
+}
+
+// Database Implementation
+Database::Database()
+    : Database(std::filesystem::current_path()) {
+}
+
+Database::Database(const std::filesystem::path& root, const OpenOptions& options)
+    : db_root_(root), catalog_(std::make_unique<Catalog>()), options_(options) {
+    if (is_initialized()) {
+        std::ifstream config(db_root_ / ".vsdb");
+        std::string line;
+        while (std::getline(config, line)) {
+            read_only_ = read_only_ || line == "read_only=1";
+        }
+        
+        // A worktree has no history of its own
+        if (!read_only_) {
+            git_store_ = std::make_unique<GitStore>(db_root_ / "objects");
+        }
+        if (options_.open_tables) {
+            load_tables();
+        }
+    }
+}
+
+Database::~Database() = default;
+
+bool Database::is_initialized() const {
+    return std::filesystem::exists(db_root_ / ".vsdb");
+}
+
+std::filesystem::path Database::get_db_path() const {
+    return db_root_;
+}
+
+std::filesystem::path Database::get_temp_dir() const {
+    return db_root_ / ".vsdb_tmp";
+}
+
+std::filesystem::path Database::get_cache_dir() const {
+    return db_root_ / ".vsdb_cache";
+}
+
+Status Database::initialize() {
+    if (is_initialized()) {
+        return Status::error("Database already initialized in " + db_root_.string());
+    }
+    
+    if (Status status = create_directory_structure(); !status) {
+        return status;
+    }
+    
+    if (Status status = create_config_file(); !status) {
+        return status;
+    }
+    
+    git_store_ = std::make_unique<GitStore>(db_root_ / "objects");
+    
+    return Status::ok();
+}
+
+Status Database::check_writable() const {
+    if (read_only_) {
+        return Status::error("Database in " + db_root_.string() + " is a read-only worktree");
+    }
+    return Status::ok();
+}
+
+Status Database::create_directory_structure() {
+    try {
+        std::filesystem::create_directories(db_root_ / "data");
+        std::filesystem::create_directories(db_root_ / "objects");
+        return Status::ok();
+    } catch (const std::filesystem::filesystem_error& e) {
+        return Status::error(std::string("Failed to create directory structure: ") + e.what());
+    }
+}
+
+Status Database::create_config_file() {
+    try {
+        std::ofstream config_file(db_root_ / ".vsdb");
+        
+        if (!config_file.is_open()) {
+            return Status::error("Failed to create configuration file");
+        }
+        
+        auto now = std::chrono::system_clock::now();
+        auto time_t = std::chrono::system_clock::to_time_t(now);
+        
+        std::stringstream ss;
+        ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+        
+        config_file << "version=1.0\n";
+        config_file << "initialized=" << ss.str() << "\n";
+        config_file << "format=vsdb\n";
+        
+        config_file.close();
+        return Status::ok();
+    } catch (const std::exception& e) {
+        return Status::error(std::string("Failed to create configuration file: ") + e.what());
+    }
+}
+
+bool Database::load_tables() {
+    ScopedTimer timer(Timer::LOAD_TABLES);
+    
+    std::filesystem::path data_dir = db_root_ / "data";
+    
+    if (!std::filesystem::exists(data_dir)) {
+        return true;
+    }
+    
+    // One read of the catalog replaces scanning data/ for schema files
+    catalog_ = std::make_unique<Catalog>();
+    bool migrate = !catalog_->load(data_dir / Catalog::kFileName);
+    
+    std::vector<TableSchema> schemas;
+    if (migrate) {
+        schemas = scan_legacy_schemas();
+    } else {
+        for (const auto& [name, entry] : catalog_->entries()) {
+            schemas.push_back(entry.schema);
+        }
+    }
+    
+    // Tables share no state while loading, so each one is read and
+    // decoded by its own task
+    std::vector<std::unique_ptr<Table>> loaded(schemas.size());
+    size_t threads = std::min(options_.load_threads, schemas.size());
+    
+    if (threads <= 1) {
+        for (size_t i = 0; i < schemas.size(); ++i) {
+            loaded[i] = Table::load_from_disk(data_dir, schemas[i], options_.reserve_rows);
+        }
+    } else {
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> tasks;
+        for (size_t i = 0; i < schemas.size(); ++i) {
+            tasks.push_back(pool.submit([&, i]() {
+                loaded[i] = Table::load_from_disk(data_dir, schemas[i], options_.reserve_rows);
+            }));
+        }
+        for (auto& task : tasks) {
+            task.get();
+        }
+    }
+    
+    for (size_t i = 0; i < schemas.size(); ++i) {
+        if (loaded[i]) {
+            tables_[schemas[i].table_name] = std::move(loaded[i]);
+        }
+    }
+    
+    if (migrate && !read_only_ && !tables_.empty()) {
+        for (const auto& [name, table] : tables_) {
+            if (!save_table(*table)) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+std::vector<TableSchema> Database::scan_legacy_schemas() const {
+    std::vector<TableSchema> schemas;
+    for (const auto& entry : std::filesystem::directory_iterator(db_root_ / "data")) {
+        if (entry.path().extension() == ".schema") {
+            TableSchema schema = TableSchema::load_from_file(entry.path());
+            schema.table_name = entry.path().stem().string();
+            schemas.push_back(std::move(schema));
+        }
+    }
+    return schemas;
+}
+
+Status Database::save_table(Table& table) {
+    std::filesystem::path data_dir = db_root_ / "data";
+    
+    if (!table.save_to_disk(data_dir)) {
+        return Status::error("Failed to save table '" + table.get_name() + "' to disk");
+    }
+    
+    CatalogEntry entry;
+    entry.schema = table.get_schema();
+    entry.row_count = table.live_row_count();
+    entry.files = table.file_names();
+    for (const auto& file : entry.files) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(data_dir / file, ec);
+        if (!ec) entry.data_bytes += size;
+    }
+    
+    catalog_->put(std::move(entry));
+    if (!catalog_->save(data_dir / Catalog::kFileName)) {
+        return Status::error("Failed to update the catalog");
+    }
+    return Status::ok();
+}
+
+Status Database::create_table(const std::string& name, const std::vector<Column>& columns,
+                              StorageType storage) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    
+    if (!is_initialized()) {
+        return Status::error("Database not initialized");
+    }
+    
+    if (table_exists(name)) {
+        return Status::error("Table '" + name + "' already exists");
+    }
+    
+    TableSchema schema;
+    schema.table_name = name;
+    schema.columns = columns;
+    schema.storage = storage;
+    
+    auto table = std::make_shared<Table>(name, schema);
+    
+    if (Status status = save_table(*table); !status) {
+        return status;
+    }
+    
+    tables_[name] = table;
+    return Status::ok();
+}
+
+bool Database::table_exists(const std::string& name) const {
+    return tables_.find(name) != tables_.end();
+}
+
+std::shared_ptr<Table> Database::get_table(const std::string& name) {
+    auto it = tables_.find(name);
+    return (it != tables_.end()) ? it->second : nullptr;
+}
+
+Status Database::insert_into(const std::string& table_name, const Record& record) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    
+    auto table = get_table(table_name);
+    if (!table) {
+        return Status::error("Table '" + table_name + "' does not exist");
+    }
+    
+    if (Status status = table->insert(record); !status) {
+        return status;
+    }
+    Metrics::instance().add(Counter::ROWS_INSERTED);
+    
+    if (deferred_writes_) {
+        dirty_tables_.insert(table_name);
+        return Status::ok();
+    }
+    return save_table(*table);
+}
+
+Status Database::select_from(const std::string& table_name, std::vector<Record>* rows) {
+    auto table = get_table(table_name);
+    if (!table) {
+        return Status::error("Table '" + table_name + "' does not exist");
+    }
+    
+    *rows = table->select_all();
+    return Status::ok();
+}
+
+Status Database::select_from(const std::string& table_name, const std::vector<Predicate>& predicates,
+                             std::vector<Record>* rows) {
+    auto table = get_table(table_name);
+    if (!table) {
+        return Status::error("Table '" + table_name + "' does not exist");
+    }
+    
+    return table->select_where(predicates, rows);
+}
+
+Status Database::create_index(const std::string& table_name, const std::string& column) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    
+    auto table = get_table(table_name);
+    if (!table) {
+        return Status::error("Table '" + table_name + "' does not exist");
+    }
+    
+    if (Status status = table->create_index(column); !status) {
+        return status;
+    }
+    
+    return save_table(*table);
+}
+
+Status Database::add_column(const std::string& table_name, const Column& column) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    
+    auto table = get_table(table_name);
+    if (!table) {
+        return Status::error("Table '" + table_name + "' does not exist");
+    }
+    
+    if (Status status = table->add_column(column); !status) {
+        return status;
+    }
+    
+    return save_table(*table);
+}
+
+Status Database::drop_column(const std::string& table_name, const std::string& column) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    
+    auto table = get_table(table_name);
+    if (!table) {
+        return Status::error("Table '" + table_name + "' does not exist");
+    }
+    
+    if (Status status = table->drop_column(column, db_root_ / "data"); !status) {
+        return status;
+    }
+    
+    return save_table(*table);
+}
+
+Status Database::open_cursor(const std::string& table_name, const ScanOptions& options,
+                             std::unique_ptr<TableCursor>* cursor) {
+    auto table = get_table(table_name);
+    if (!table) {
+        return Status::error("Table '" + table_name + "' does not exist");
+    }
+    
+    return table->open_cursor(options, cursor);
+}
+
+Status Database::update(const std::string& table_name, const std::vector<Predicate>& predicates,
+                        const std::vector<Assignment>& assignments, size_t* count) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    
+    auto table = get_table(table_name);
+    if (!table) {
+        return Status::error("Table '" + table_name + "' does not exist");
+    }
+    
+    size_t updated = 0;
+    if (Status status = table->update_where(predicates, assignments, &updated); !status) {
+        return status;
+    }
+    Metrics::instance().add(Counter::ROWS_UPDATED, updated);
+    if (count) {
+        *count = updated;
+    }
+    
+    if (updated == 0) {
+        return Status::ok();
+    }
+    if (deferred_writes_) {
+        dirty_tables_.insert(table_name);
+        return Status::ok();
+    }
+    return save_table(*table);
+}
+
+Status Database::delete_from(const std::string& table_name, const std::vector<Predicate>& predicates,
+                             size_t* count) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    
+    auto table = get_table(table_name);
+    if (!table) {
+        return Status::error("Table '" + table_name + "' does not exist");
+    }
+    
+    size_t deleted = 0;
+    if (Status status = table->delete_where(predicates, &deleted); !status) {
+        return status;
+    }
+    Metrics::instance().add(Counter::ROWS_DELETED, deleted);
+    if (count) {
+        *count = deleted;
+    }
+    
+    if (deleted == 0) {
+        return Status::ok();
+    }
+    if (deferred_writes_) {
+        dirty_tables_.insert(table_name);
+        return Status::ok();
+    }
+    return save_table(*table);
+}
+
+Status Database::flush() {
+    for (auto it = dirty_tables_.begin(); it != dirty_tables_.end();) {
+        auto table = get_table(*it);
+        if (table) {
+            if (Status status = save_table(*table); !status) {
+                return status;
+            }
+        }
+        it = dirty_tables_.erase(it);
+    }
+    return Status::ok();
+}
+
+Status Database::hash_tables(std::vector<std::string>* row_roots) {
+    TraceSpan span("hash_tables");
+    row_roots->clear();
+    for (const auto& [name, table] : tables_) {
+        row_roots->push_back(name + ":" + table->row_root());
+        
+        // Keep the hashes so the next commit rehashes only what changes
+        if (table->row_hashes_dirty()) {
+            if (Status status = save_table(*table); !status) {
+                return status;
+            }
+        }
+    }
+    return Status::ok();
+}
+
+Status Database::commit(const std::string& message, std::string* commit_hash) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    if (!git_store_) {
+        return Status::error("Git store not initialized");
+    }
+    
+    if (Status status = flush(); !status) {
+        return status;
+    }
+    wait_for_commits();
+    
+    std::vector<std::string> row_roots;
+    if (Status status = hash_tables(&row_roots); !status) {
+        return status;
+    }
+    
+    std::string hash = git_store_->commit(message, db_root_ / "data", row_roots);
+    if (hash.empty()) {
+        return Status::error("Failed to write commit");
+    }
+    
+    if (commit_hash) {
+        *commit_hash = hash;
+    }
+    return Status::ok();
+}
+
+Status Database::snapshot_data(const std::filesystem::path& dir,
+                               std::vector<FrozenPageFile>* frozen) const {
+    TraceSpan span("snapshot_data");
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        return Status::error("Failed to create snapshot directory " + dir.string());
+    }
+    
+    for (const auto& entry : std::filesystem::directory_iterator(db_root_ / "data")) {
+        auto ext = entry.path().extension();
+        if (!entry.is_regular_file() || ext == ".tmp" || ext == ".compact") continue;
+        
+        // Table files are only ever replaced whole, so a hard link keeps
+        // the current version. Page files are appended to in place: they
+        // are linked too, with the few bytes appends can still rewrite, and
+        // the committer copies them out (see commit_async).
+        std::filesystem::path target = dir / entry.path().filename();
+        bool paged = ext == ".pages" || ext == ".pagedir";
+        PagedStore::MutableParts parts;
+        if (paged && !PagedStore::read_mutable_parts(entry.path(), ext == ".pagedir", &parts)) {
+            return Status::error("Failed to snapshot " + entry.path().filename().string());
+        }
+        
+        std::filesystem::create_hard_link(entry.path(), target, ec);
+        if (!ec) {
+            if (paged) {
+                frozen->push_back({target, std::move(parts)});
+            }
+        } else if (!std::filesystem::copy_file(entry.path(), target, ec)) {
+            return Status::error("Failed to snapshot " + entry.path().filename().string());
+        }
+    }
+    
+    return Status::ok();
+}
+
+void Database::wait_for_commits() const {
+    if (committer_) {
+        committer_->submit([]() {}).get();
+    }
+}
+
+std::future<CommitResult> Database::commit_async(const std::string& message) {
+    if (read_only_ || !git_store_) {
+        std::promise<CommitResult> failed;
+        failed.set_value({read_only_ ? check_writable() : Status::error("Git store not initialized"), ""});
+        return failed.get_future();
+    }
+    
+    std::vector<std::string> row_roots;
+    Status prepared = flush();
+    if (prepared) {
+        prepared = hash_tables(&row_roots);
+    }
+    if (!prepared) {
+        std::promise<CommitResult> failed;
+        failed.set_value({prepared, ""});
+        return failed.get_future();
+    }
+    
+    static std::atomic<uint64_t> next_snapshot{0};
+    std::filesystem::path dir = get_temp_dir() /
+        ("snapshot-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+         "-" + std::to_string(next_snapshot++));
+    
+    std::vector<FrozenPageFile> frozen;
+    if (Status status = snapshot_data(dir, &frozen); !status) {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        
+        std::promise<CommitResult> failed;
+        failed.set_value({status, ""});
+        return failed.get_future();
+    }
+    
+    if (!committer_) {
+        committer_ = std::make_unique<ThreadPool>(1);
+    }
+    
+    return committer_->submit([this, message, dir, row_roots, frozen = std::move(frozen)]() {
+        CommitResult result;
+        for (const auto& file : frozen) {
+            if (!PagedStore::freeze_copy(file.link, file.parts)) {
+                result.status = Status::error("Failed to snapshot " + file.link.filename().string());
+                break;
+            }
+        }
+        
+        if (result.status) {
+            result.hash = git_store_->commit(message, dir, row_roots);
+            if (result.hash.empty()) {
+                result.status = Status::error("Failed to write commit");
+            }
+        }
+        
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        return result;
+    });
+}
+
+std::vector<Commit> Database::get_log() {
+    if (!git_store_) {
+        return {};
+    }
+    
+    wait_for_commits();
+    
+    return git_store_->get_log();
+}
+
+Status Database::checkout(const std::string& commit_hash) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    if (!git_store_) {
+        return Status::error("Git store not initialized");
+    }
+    
+    wait_for_commits();
+    
+    Status status = git_store_->checkout(commit_hash, db_root_ / "data");
+    
+    // Reload tables from disk, even after a partial restore; unsaved
+    // changes are discarded like any uncommitted change
+    dirty_tables_.clear();
+    tables_.clear();
+    load_tables();
+    
+    return status;
+}
+
+Status Database::resolve_commit(const std::string& ref, std::string* commit_hash) {
+    if (!git_store_) {
+        return Status::error("Git store not initialized");
+    }
+    
+    wait_for_commits();
+    
+    std::string hash = ref;
+    if (ref == "HEAD") {
+        auto head = git_store_->get_head();
+        if (!head) {
+            return Status::error("No commits yet");
+        }
+        hash = *head;
+    }
+    
+    if (!git_store_->get_commit(hash)) {
+        return Status::error("Commit " + ref + " not found");
+    }
+    *commit_hash = hash;
+    return Status::ok();
+}
+
+Status Database::prove_row(const std::string& table_name, size_t row_id, const std::string& commit_ref,
+                           RowProof* proof) {
+    std::string hash;
+    if (Status status = resolve_commit(commit_ref, &hash); !status) {
+        return status;
+    }
+    
+    auto commit = git_store_->get_commit(hash);
+    auto leaves = commit->tree_leaves();
+    std::string leaf = "rows:" + table_name + ":";
+    auto it = std::find_if(leaves.begin(), leaves.end(),
+                           [&](const std::string& l) { return l.compare(0, leaf.size(), leaf) == 0; });
+    if (commit->tree_root.empty() || it == leaves.end()) {
+        return Status::error("Commit " + hash + " has no row hashes for table '" + table_name + "'");
+    }
+    
+    // Hash the rows as committed, in a read-only copy; the name is unique
+    // across processes sharing the temp directory
+    static std::atomic<uint64_t> next_proof{0};
+    struct RemoveOnExit {
+        std::filesystem::path dir;
+        ~RemoveOnExit() {
+            std::error_code ec;
+            std::filesystem::remove_all(dir, ec);
+        }
+    } copy{get_temp_dir() /
+           ("prove-" + std::to_string(getpid()) + "-" +
+            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+            "-" + std::to_string(next_proof++))};
+    
+    if (Status status = materialize(hash, {table_name}, copy.dir); !status) {
+        return status;
+    }
+    {
+        Database snapshot(copy.dir);
+        auto table = snapshot.get_table(table_name);
+        if (!table) {
+            return Status::error("Table '" + table_name + "' does not exist in commit " + hash);
+        }
+        if (Status status = table->prove_row(row_id, proof); !status) {
+            return status;
+        }
+    }
+    
+    if (*it != leaf + proof->row_root) {
+        return Status::error("Rows of table '" + table_name + "' do not match commit " + hash);
+    }
+    
+    MerkleTree tree(leaves);
+    proof->commit = hash;
+    proof->tree_path = tree.proof(static_cast<size_t>(it - leaves.begin()));
+    proof->tree_root = tree.root();
+    proof->header = commit->header();
+    return Status::ok();
+}
+
+Status Database::fsck(const FsckOptions& options, FsckReport* report) {
+    if (!git_store_) {
+        return Status::error("Git store not initialized");
+    }
+    
+    wait_for_commits();
+    return git_store_->fsck(options, report);
+}
+
+namespace {
+
+// Whether a data file belongs to one of the tables
+bool is_table_file(const std::string& filename, const std::vector<std::string>& tables) {
+    for (const auto& table : tables) {
+        if (filename.size() > table.size() && filename.compare(0, table.size(), table) == 0 &&
+            filename[table.size()] == '.') {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Worktrees are registered by absolute path without a trailing separator
+std::filesystem::path worktree_root(const std::filesystem::path& dir) {
+    std::filesystem::path root = std::filesystem::absolute(dir).lexically_normal();
+    return root.filename().empty() ? root.parent_path() : root;
+}
+
+} // namespace
+
+Status Database::table_objects(const std::string& commit_hash, const std::vector<std::string>& tables,
+                               std::vector<std::string>* objects) {
+    if (!git_store_) {
+        return Status::error("Git store not initialized");
+    }
+    
+    auto commit = git_store_->get_commit(commit_hash);
+    if (!commit) {
+        return Status::error("Commit " + commit_hash + " not found");
+    }
+    
+    objects->clear();
+    for (const auto& file_hash : commit->file_hashes) {
+        if (is_table_file(file_hash.substr(0, file_hash.find(':')), tables)) {
+            objects->push_back(file_hash);
+        }
+    }
+    std::sort(objects->begin(), objects->end());
+    return Status::ok();
+}
+
+Status Database::materialize(const std::string& commit_hash, const std::vector<std::string>& tables,
+                             const std::filesystem::path& root) {
+    if (!git_store_) {
+        return Status::error("Git store not initialized");
+    }
+    
+    auto commit = git_store_->get_commit(commit_hash);
+    if (!commit) {
+        return Status::error("Commit " + commit_hash + " not found");
+    }
+    
+    std::error_code ec;
+    std::filesystem::create_directories(root / "data", ec);
+    if (ec) {
+        return Status::error("Failed to create " + root.string());
+    }
+    
+    // The table files are links into the object store, so the copy must
+    // never be written: its config marks it read-only
+    {
+        std::ofstream config(root / ".vsdb");
+        config << "version=1.0\n";
+        config << "format=vsdb\n";
+        config << "read_only=1\n";
+        config << "source=" << std::filesystem::absolute(db_root_).string() << "\n";
+        config << "commit=" << commit_hash << "\n";
+        if (!config.flush()) {
+            return Status::error("Failed to create " + (root / ".vsdb").string());
+        }
+    }
+    
+    // Tables left out keep their catalog entry and load empty
+    return git_store_->restore_files(*commit, root / "data", [&](const std::string& filename) {
+        return filename == Catalog::kFileName || tables.empty() || is_table_file(filename, tables);
+    }, true);
+}
+
+Status Database::add_worktree(const std::filesystem::path& dir, const std::string& commit_ref,
+                              std::string* commit_hash) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    
+    std::string hash;
+    if (Status status = resolve_commit(commit_ref, &hash); !status) {
+        return status;
+    }
+    
+    std::error_code ec;
+    if (std::filesystem::exists(dir) && !std::filesystem::is_empty(dir, ec)) {
+        return Status::error("Worktree directory " + dir.string() + " is not empty");
+    }
+    
+    std::filesystem::path root = worktree_root(dir);
+    if (Status status = materialize(hash, {}, root); !status) {
+        std::filesystem::remove_all(root, ec);
+        return status;
+    }
+    
+    if (Status status = git_store_->add_worktree({hash, root}); !status) {
+        std::filesystem::remove_all(root, ec);
+        return status;
+    }
+    
+    if (commit_hash) {
+        *commit_hash = hash;
+    }
+    return Status::ok();
+}
+
+Status Database::remove_worktree(const std::filesystem::path& dir) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    if (!git_store_) {
+        return Status::error("Git store not initialized");
+    }
+    
+    std::filesystem::path root = worktree_root(dir);
+    if (Status status = git_store_->remove_worktree(root); !status) {
+        return status;
+    }
+    
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    if (ec) {
+        return Status::error("Failed to remove " + root.string() + ": " + ec.message());
+    }
+    return Status::ok();
+}
+
+std::vector<WorktreeRef> Database::get_worktrees() const {
+    return git_store_ ? git_store_->get_worktrees() : std::vector<WorktreeRef>{};
+}
+
+Status Database::prune(const RetentionPolicy& policy, bool dry_run, PruneStats* stats) {
+    if (Status status = check_writable(); !status) {
+        return status;
+    }
+    if (!git_store_) {
+        return Status::error("Git store not initialized");
+    }
+    
+    wait_for_commits();
+    return git_store_->prune(policy, dry_run, stats);
+}
+
+std::vector<TableStats> Database::get_table_stats() {
+    std::vector<TableStats> stats;
+    
+    // Catalog entries are ordered by name
+    for (const auto& [name, entry] : catalog_->entries()) {
+        TableStats ts;
+        ts.name = name;
+        auto table = tables_.find(name);
+        ts.row_count = table != tables_.end() ? table->second->live_row_count() : entry.row_count;
+        ts.column_count = entry.schema.columns.size();
+        ts.schema_version = entry.schema.version;
+        ts.data_bytes = entry.data_bytes;
+        stats.push_back(ts);
+    }
+    
+    return stats;
+}
+
+std::optional<ObjectStoreStats> Database::get_object_stats() const {
+    if (!git_store_) {
+        return std::nullopt;
+    }
+    
+    wait_for_commits();
+    return git_store_->get_stats();
 }
 
 } // namespace vsdb
\ No newline at end of file
@@ -3,30 +3,52 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
+#include <optional>
+#include "db/predicate.h"
+#include "db/value.h"
 #include "gitstore/gitstore.h"
+#include "index/bloom_filter.h"
+#include "index/secondary_index.h"
+#include "index/zone_map.h"
+#include "storage/dictionary.h"
+#include "storage/paged_store.h"
+#include "util/status.h"
+#include "util/thread_pool.h"
 
 namespace vsdb {
 
-enum class DataType {
-    INT,
-    FLOAT,
-    TEXT,
-    BOOL
-};
-
 struct Column {
     std::string name;
     DataType type;
     bool primary_key = false;
+    uint32_t id = 0;            // Position of the column's value in stored rows; never reused
+    std::string default_value;  // Read for rows stored before the column was added
 };
 
+enum class StorageType {
+    MEMORY, // Rows loaded from <table>.data into memory on open
+    PAGED   // Rows in <table>.pages, read through a buffer pool
+};
+
+// Columns are added and dropped without rewriting rows: stored rows
+// keep the layout they were written with, one value per column id, and
+// are adapted to the current columns when read
 struct TableSchema {
     std::string table_name;
     std::vector<Column> columns;
+    StorageType storage = StorageType::MEMORY;
+    uint32_t version = 1;         // Incremented by every schema change
+    uint32_t next_column_id = 0;  // 0 until the columns are numbered
+    
+    std::optional<size_t> find_column(const std::string& name) const;
     
-    bool save_to_file(const std::filesystem::path& path) const;
+    // Per-table <table>.schema files, read only from databases created
+    // before the catalog
     static TableSchema load_from_file(const std::filesystem::path& path);
 };
 
@@ -34,61 +56,418 @@ struct Record {
     std::vector<std::string> values;
 };
 
+// "column=value" in an update
+struct Assignment {
+    std::string column;
+    std::string value;
+    
+    static std::optional<Assignment> parse(const std::string& expr);
+};
+
+// Fills the batch with the next rows; returns false once exhausted
+using BatchSource = std::function<bool(std::vector<Record>&)>;
+
+struct ScanOptions {
+    std::vector<Predicate> predicates;
+    size_t offset = 0;              // Matching rows to skip
+    std::optional<size_t> limit;    // Stop after this many rows
+    size_t row_begin = 0;           // Only rows with ids in [row_begin, row_end)
+    std::optional<size_t> row_end;
+};
+
+class Table;
+class Catalog;
+
+// Inclusion proof of one row in a commit: the row hashes up to its block,
+// the block to the table's row root, and that root's tree leaf to the
+// tree root, which with the commit header gives the commit hash
+struct RowProof {
+    std::string commit;
+    std::string table;
+    size_t row_id = 0;
+    std::optional<Record> row;            // Empty if the row is deleted
+    std::vector<MerkleStep> block_path;   // Row to its block
+    std::vector<MerkleStep> table_path;   // Block to the row root
+    std::string row_root;
+    std::vector<MerkleStep> tree_path;    // "rows:<table>:<root>" to the tree root
+    std::string tree_root;
+    std::string header;                   // Commit::header() of the commit
+    
+    size_t hash_count() const { return block_path.size() + table_path.size() + tree_path.size(); }
+    
+    // Recompute every step from the row and compare with the commit hash
+    bool verify() const;
+};
+
+// Iterates the rows of a table matching a scan, one batch at a time.
+// The scan stops as soon as the limit is reached, or at the first row
+// that cannot be read; status() tells the two apart. A cursor must not
+// outlive its table or be used across inserts into it.
+class TableCursor {
+public:
+    static constexpr size_t kDefaultBatchSize = 1024;
+    
+    bool next_batch(std::vector<Record>& batch, size_t batch_size = kDefaultBatchSize);
+    bool next(Record& record);
+    
+    // Ask for the dictionary codes of these columns alongside each batch
+    void request_codes(const std::vector<size_t>& columns);
+    
+    // Codes of the i-th requested column for the last batch, or nullptr
+    // if that column is not dictionary encoded
+    const std::vector<uint32_t>* batch_codes(size_t i) const;
+    
+    // Error that ended the scan early, if any
+    const Status& status() const { return status_; }
+    
+private:
+    friend class Table;
+    
+    // Equality on a dictionary-encoded column, evaluated on codes
+    struct CodedPredicate {
+        const DictionaryColumn* dictionary = nullptr;
+        std::optional<uint32_t> code; // Empty if the value never occurs
+    };
+    
+    TableCursor(const Table& table, std::vector<BoundPredicate> predicates,
+                size_t offset, std::optional<size_t> limit);
+    
+    // Record the row id of every returned row in batch_rows_
+    void track_rows() { track_rows_ = true; }
+    
+    bool matches(size_t row_id, const Record& record) const;
+    
+    // False if the zone map rules out every row of the block
+    bool block_may_match(size_t block) const;
+    
+    const Table& table_;
+    std::vector<BoundPredicate> predicates_;
+    std::vector<CodedPredicate> coded_;
+    std::vector<const DictionaryColumn*> code_columns_;
+    std::vector<std::vector<uint32_t>> batch_codes_;
+    std::optional<std::vector<size_t>> row_ids_; // Candidate rows from an index
+    size_t position_ = 0;
+    std::optional<size_t> row_end_;
+    size_t offset_;
+    std::optional<size_t> limit_;
+    size_t skipped_ = 0;
+    size_t returned_ = 0;
+    bool track_rows_ = false;
+    std::vector<size_t> batch_rows_;
+    Status status_;
+    
+    std::vector<Record> buffer_;
+    size_t buffer_pos_ = 0;
+};
+
 class Table {
 public:
     Table(const std::string& name, const TableSchema& schema);
     
-    bool insert(const Record& record);
+    Status insert(const Record& record);
     std::vector<Record> select_all() const;
     
+    // Row ids in use, including deleted rows
+    size_t row_count() const;
+    size_t live_row_count() const { return row_count() - deleted_count_; }
+    
+    // Mutations touch only the affected rows: a delete sets a tombstone and
+    // an update records a new version of the row under the same row id.
+    // Both are kept in <table>.delta until compaction.
+    Status delete_where(const std::vector<Predicate>& predicates, size_t* count);
+    Status update_where(const std::vector<Predicate>& predicates,
+                        const std::vector<Assignment>& assignments, size_t* count);
+    
+    // Compact once this fraction of row ids hold deleted or superseded rows
+    static constexpr double kCompactionThreshold = 0.25;
+    bool needs_compaction() const;
+    
+    // Rewrite the base rows without tombstones and with updates applied.
+    // Row ids change, so indexes, zones and the key filter are rebuilt.
+    // Paged rows go to staging files; the next save writes every other
+    // file of the table beside them and swaps them all in together.
+    bool compact(const std::filesystem::path& data_dir);
+    
+    // Rows matching all predicates; uses a secondary index when one applies
+    Status select_where(const std::vector<Predicate>& predicates, std::vector<Record>* rows) const;
+    
+    // Streaming scan; fails if a predicate names an unknown column
+    Status open_cursor(const ScanOptions& options, std::unique_ptr<TableCursor>* cursor) const;
+    
+    // Merkle root over every row id, from one hash per zone block of rows.
+    // Only blocks changed since the last call are rehashed.
+    std::string row_root();
+    bool row_hashes_dirty() const { return rows_dirty_; }
+    
+    // Fills the row, block and table steps of a proof
+    Status prove_row(size_t row_id, RowProof* proof);
+    
+    // Leaf contents of a row; a deleted row keeps its id with a marker
+    static std::string row_leaf(const Record* row);
+    
+    // Schema changes; neither rewrites stored rows. Primary key columns
+    // cannot be added or dropped, and an index on a dropped column is
+    // deleted from `data_dir`.
+    Status add_column(const Column& column);
+    Status drop_column(const std::string& name, const std::filesystem::path& data_dir);
+    
+    // Secondary indexes
+    Status create_index(const std::string& column);
+    bool has_index(const std::string& column) const;
+    
+    // Dictionary of a TEXT column, if it is currently encoded. Codes
+    // describe the base rows, so none is offered while updates are pending.
+    const DictionaryColumn* get_dictionary(size_t column) const;
+    
     const TableSchema& get_schema() const { return schema_; }
     std::string get_name() const { return name_; }
     
+    // Names of the table's files in data/
+    std::vector<std::string> file_names() const;
+    
+    // The schema itself is kept in the catalog, not with the table
     bool save_to_disk(const std::filesystem::path& data_dir);
+    // `reserve_rows` pre-sizes row storage from the .data header
     static std::unique_ptr<Table> load_from_disk(
         const std::filesystem::path& data_dir, 
-        const std::string& table_name
+        const TableSchema& schema,
+        bool reserve_rows = true
     );
     
 private:
+    friend class TableCursor;
+    
     std::string name_;
     TableSchema schema_;
     std::vector<Record> records_;
+    std::unique_ptr<PagedStore> paged_;
+    std::unordered_map<std::string, std::unique_ptr<SecondaryIndex>> indexes_;
+    std::unordered_map<size_t, DictionaryColumn> dictionaries_; // By column position
+    ZoneMap zones_;
+    std::vector<size_t> key_columns_;           // Primary key column positions
+    std::unique_ptr<BloomFilter> key_filter_;   // Null without a primary key
+    bool filter_dirty_ = true;                  // Key filter changed since the last save
+    
+    std::vector<bool> deleted_;                   // Tombstones by row id; may be shorter than row_count()
+    size_t deleted_count_ = 0;
+    std::unordered_map<size_t, Record> versions_; // Current version of updated rows
+    bool base_dirty_ = true;                      // Rows or indexes changed since the last save
+    bool delta_dirty_ = false;                    // Tombstones or versions changed since the last save
+    std::vector<std::string> block_hashes_;       // By zone block; empty where stale
+    bool rows_dirty_ = true;                      // Block hashes changed since the last save
+    bool identity_layout_ = true;                 // Column i is stored at position i
+    bool legacy_data_ = false;                    // .data written without its slot count
+    bool compaction_pending_ = false;             // Compacted since the last save
+    
+    // Current row by id, or nullptr if deleted; `scratch` holds rows
+    // decoded from pages
+    const Record* row_at(size_t row_id, Record& scratch) const;
+    // Row as stored in the base data, ignoring tombstones and versions
+    const Record* base_row_at(size_t row_id, Record& scratch) const;
+    bool is_deleted(size_t row_id) const {
+        return row_id < deleted_.size() && deleted_[row_id];
+    }
+    
+    // Ids of the current rows matching all predicates
+    Status matching_rows(const std::vector<Predicate>& predicates, std::vector<size_t>* rows) const;
+    bool open_paged_store(const std::filesystem::path& data_dir);
+    
+    // Recompute the stored layout and key positions after the columns change
+    void update_layout();
+    // Stored row to the current columns; values of dropped columns are
+    // removed and columns added since the row was written take their default
+    void adapt_row(std::vector<std::string>& values) const;
+    // Current columns to the stored layout, using `scratch` unless the
+    // layout is the identity
+    const std::vector<std::string>& stored_row(const std::vector<std::string>& values,
+                                               std::vector<std::string>& scratch) const;
+    
+    // Start or stop dictionary encoding of TEXT columns by cardinality
+    void choose_dictionaries();
+    bool write_data_file(const std::filesystem::path& path) const;
+    bool write_delta_file(const std::filesystem::path& path) const;
+    bool load_delta_file(const std::filesystem::path& path);
+    bool write_rows_file(const std::filesystem::path& path) const;
+    void load_rows_file(const std::filesystem::path& path);
+    
+    // A compacted table's files are saved as <file>.compact, then listed
+    // in <table>.compact, which makes the swap happen: from then on
+    // finish_compaction moves every staged file into place, also after a
+    // crash. Staged files without that list are discarded.
+    bool publish_compaction(const std::filesystem::path& data_dir, const std::vector<std::string>& staged);
+    bool finish_compaction(const std::filesystem::path& data_dir);
+    
+    // Mark the block holding a row for rehashing
+    void touch_block(size_t row_id);
+    std::vector<std::string> block_leaves(size_t block) const;
+    
+    // Recompute the zone map from the stored rows
+    void rebuild_zones();
+    
+    // Primary key of a row, normalized so equal typed values match
+    std::string key_of(const std::vector<std::string>& values) const;
+    // Whether a row with this key exists; the Bloom filter answers most misses
+    bool key_exists(const std::string& key) const;
+    void rebuild_key_filter();
     
-    std::filesystem::path get_schema_path(const std::filesystem::path& data_dir) const;
     std::filesystem::path get_data_path(const std::filesystem::path& data_dir) const;
+    std::filesystem::path get_zones_path(const std::filesystem::path& data_dir) const;
+    std::filesystem::path get_bloom_path(const std::filesystem::path& data_dir) const;
+    std::filesystem::path get_delta_path(const std::filesystem::path& data_dir) const;
+    std::filesystem::path get_rows_path(const std::filesystem::path& data_dir) const;
+    std::filesystem::path get_compaction_path(const std::filesystem::path& data_dir) const;
+    static std::filesystem::path get_index_path(
+        const std::filesystem::path& data_dir,
+        const std::string& table_name,
+        const std::string& column
+    );
+};
+
+struct TableStats {
+    std::string name;
+    size_t row_count = 0;
+    size_t column_count = 0;
+    uint32_t schema_version = 1;
+    uintmax_t data_bytes = 0; // Size of the table's files in data/
+};
+
+struct CommitResult {
+    Status status;
+    std::string hash;
+};
+
+// How existing tables are loaded when a Database is opened
+struct OpenOptions {
+    size_t load_threads = ThreadPool::default_threads(); // 1 loads on the caller's thread
+    bool reserve_rows = true; // Pre-size row storage from each table's row count
+    bool open_tables = true;  // False opens only the object store, for read-only queries over commits
 };
 
+// Embedding entry point. Errors are returned as Status; nothing is
+// printed. One Database per directory per process. A Database opened on
+// a worktree is read-only: every operation that writes fails.
 class Database {
 public:
-    Database();
+    Database(); // Rooted at the current directory
+    explicit Database(const std::filesystem::path& root, const OpenOptions& options = {});
+    ~Database();
     
-    bool initialize();
+    Status initialize();
     bool is_initialized() const;
+    bool is_read_only() const { return read_only_; }
     std::filesystem::path get_db_path() const;
+    std::filesystem::path get_temp_dir() const; // Scratch space for spilling operators
+    std::filesystem::path get_cache_dir() const; // Query results over committed data
     
     // Table management
-    bool create_table(const std::string& name, const std::vector<Column>& columns);
+    Status create_table(const std::string& name, const std::vector<Column>& columns,
+                        StorageType storage = StorageType::MEMORY);
     bool table_exists(const std::string& name) const;
     std::shared_ptr<Table> get_table(const std::string& name);
+    Status create_index(const std::string& table_name, const std::string& column);
+    
+    // ALTER TABLE ADD/DROP COLUMN; metadata only, see Table::add_column
+    Status add_column(const std::string& table_name, const Column& column);
+    Status drop_column(const std::string& table_name, const std::string& column);
     
     // Data operations
-    bool insert_into(const std::string& table_name, const Record& record);
-    std::vector<Record> select_from(const std::string& table_name);
+    Status insert_into(const std::string& table_name, const Record& record);
+    Status select_from(const std::string& table_name, std::vector<Record>* rows);
+    Status select_from(const std::string& table_name, const std::vector<Predicate>& predicates,
+                       std::vector<Record>* rows);
+    Status open_cursor(const std::string& table_name, const ScanOptions& options,
+                       std::unique_ptr<TableCursor>* cursor);
+    Status update(const std::string& table_name, const std::vector<Predicate>& predicates,
+                  const std::vector<Assignment>& assignments, size_t* count = nullptr);
+    Status delete_from(const std::string& table_name, const std::vector<Predicate>& predicates,
+                       size_t* count = nullptr);
+    
+    // With deferred writes, changed tables stay in memory until flush() or
+    // a commit instead of being saved after every insert. Changes not yet
+    // flushed are lost when the Database is destroyed.
+    void set_deferred_writes(bool deferred) { deferred_writes_ = deferred; }
+    Status flush();
     
     // Version control operations
-    std::string commit(const std::string& message);
+    Status commit(const std::string& message, std::string* commit_hash = nullptr);
+    
+    // Freeze the current table files and commit them on a background
+    // thread; writers can continue as soon as this returns. Commits
+    // complete in the order they were requested.
+    std::future<CommitResult> commit_async(const std::string& message);
+    
     std::vector<Commit> get_log();
-    bool checkout(const std::string& commit_hash);
+    Status checkout(const std::string& commit_hash);
+    
+    // Full commit hash for "HEAD" or a commit hash
+    Status resolve_commit(const std::string& ref, std::string* commit_hash);
+    
+    // Inclusion proof of a row of `table_name` as of a commit
+    Status prove_row(const std::string& table_name, size_t row_id, const std::string& commit_ref,
+                     RowProof* proof);
+    
+    // Verify the object store; see GitStore::fsck
+    Status fsck(const FsckOptions& options, FsckReport* report);
+    
+    // "<file>:<object hash>" for every file of the tables in a commit,
+    // sorted; identifies the committed contents of those tables
+    Status table_objects(const std::string& commit_hash, const std::vector<std::string>& tables,
+                         std::vector<std::string>* objects);
+    
+    // Link the catalog and the files of `tables` (all tables if empty) as
+    // of a commit into `root`, which then opens as a read-only Database
+    Status materialize(const std::string& commit_hash, const std::vector<std::string>& tables,
+                       const std::filesystem::path& root);
+    
+    // Worktrees: a commit materialized in its own directory, so several
+    // versions can be queried at once without copying table files
+    Status add_worktree(const std::filesystem::path& dir, const std::string& commit_ref,
+                        std::string* commit_hash = nullptr);
+    Status remove_worktree(const std::filesystem::path& dir);
+    std::vector<WorktreeRef> get_worktrees() const;
+    Status prune(const RetentionPolicy& policy, bool dry_run, PruneStats* stats);
+    
+    // Statistics
+    std::vector<TableStats> get_table_stats();
+    std::optional<ObjectStoreStats> get_object_stats() const;
     
 private:
     std::filesystem::path db_root_;
     std::unordered_map<std::string, std::shared_ptr<Table>> tables_;
     std::unique_ptr<GitStore> git_store_;
+    std::unique_ptr<Catalog> catalog_;
+    OpenOptions options_;
+    std::unique_ptr<ThreadPool> committer_; // Single worker for async commits; drained on destruction
+    bool deferred_writes_ = false;
+    bool read_only_ = false;
+    std::unordered_set<std::string> dirty_tables_; // Unsaved under deferred writes
     
-    bool create_directory_structure();
-    bool create_config_file();
+    Status create_directory_structure();
+    Status create_config_file();
+    Status check_writable() const;
     bool load_tables();
+    
+    // Save a changed table and record it in the catalog
+    Status save_table(Table& table);
+    
+    // "<table>:<row root>" for every table, with the hashes saved
+    Status hash_tables(std::vector<std::string>* row_roots);
+    
+    // Table schemas from <table>.schema files, for databases without a catalog
+    std::vector<TableSchema> scan_legacy_schemas() const;
+    
+    // A page file hard-linked into a snapshot, still shared with the live
+    // table; PagedStore::freeze_copy turns it into the snapshot's own copy
+    struct FrozenPageFile {
+        std::filesystem::path link;
+        PagedStore::MutableParts parts;
+    };
+    
+    // Link (or copy) the files of data/ into `dir` as an immutable snapshot
+    Status snapshot_data(const std::filesystem::path& dir, std::vector<FrozenPageFile>* frozen) const;
+    
+    // Block until every requested async commit has finished
+    void wait_for_commits() const;
 };
 
 } // namespace vsdb
\ No newline at end of file
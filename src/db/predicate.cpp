@@ -0,0 +1,51 @@
+#include "db/predicate.h"
+
+namespace vsdb {
+
+std::optional<Predicate> Predicate::parse(const std::string& expr) {
+    size_t pos = expr.find_first_of("=<>!");
+    if (pos == std::string::npos || pos == 0) {
+        return std::nullopt;
+    }
+    
+    Predicate pred;
+    pred.column = expr.substr(0, pos);
+    
+    std::string op = expr.substr(pos, 2);
+    if (op == ">=") {
+        pred.op = CompareOp::GE;
+    } else if (op == "<=") {
+        pred.op = CompareOp::LE;
+    } else if (op == "!=") {
+        pred.op = CompareOp::NE;
+    } else if (op[0] == '=') {
+        pred.op = CompareOp::EQ;
+        op = "=";
+    } else if (op[0] == '<') {
+        pred.op = CompareOp::LT;
+        op = "<";
+    } else if (op[0] == '>') {
+        pred.op = CompareOp::GT;
+        op = ">";
+    } else {
+        return std::nullopt;
+    }
+    
+    pred.value = expr.substr(pos + op.size());
+    return pred;
+}
+
+bool Predicate::evaluate(CompareOp op, const TypedValue& lhs, const TypedValue& rhs) {
+    int cmp = lhs.compare(rhs);
+    switch (op) {
+        case CompareOp::EQ: return cmp == 0;
+        case CompareOp::NE: return cmp != 0;
+        case CompareOp::LT: return cmp < 0;
+        case CompareOp::LE: return cmp <= 0;
+        case CompareOp::GT: return cmp > 0;
+        case CompareOp::GE: return cmp >= 0;
+    }
+    return false;
+}
+
+} // namespace vsdb
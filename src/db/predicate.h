@@ -0,0 +1,41 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include "db/value.h"
+
+namespace vsdb {
+
+enum class CompareOp {
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE
+};
+
+// A single "column <op> value" filter, e.g. "age>=30"
+struct Predicate {
+    std::string column;
+    CompareOp op = CompareOp::EQ;
+    std::string value;
+    
+    static std::optional<Predicate> parse(const std::string& expr);
+    
+    // Evaluate against a value of the same type as the bound operand
+    static bool evaluate(CompareOp op, const TypedValue& lhs, const TypedValue& rhs);
+};
+
+// A predicate resolved against a schema: column position and typed operand
+struct BoundPredicate {
+    size_t column;
+    CompareOp op;
+    TypedValue operand;
+    
+    bool matches(const std::string& raw) const {
+        return Predicate::evaluate(op, TypedValue::parse(operand.type, raw), operand);
+    }
+};
+
+} // namespace vsdb
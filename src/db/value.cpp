@@ -0,0 +1,74 @@
+#include "db/value.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace vsdb {
+
+TypedValue TypedValue::parse(DataType type, const std::string& raw) {
+    TypedValue value;
+    value.type = type;
+    
+    switch (type) {
+        case DataType::INT:
+            value.int_value = std::strtoll(raw.c_str(), nullptr, 10);
+            break;
+        case DataType::FLOAT:
+            value.float_value = std::strtod(raw.c_str(), nullptr);
+            break;
+        case DataType::BOOL:
+            value.int_value = (raw == "1" || raw == "true" || raw == "TRUE") ? 1 : 0;
+            break;
+        case DataType::TEXT:
+            value.text_value = raw;
+            break;
+    }
+    
+    return value;
+}
+
+std::string TypedValue::to_string() const {
+    switch (type) {
+        case DataType::INT:
+        case DataType::BOOL:
+            return std::to_string(int_value);
+        case DataType::FLOAT: {
+            std::ostringstream ss;
+            ss.precision(17);
+            ss << float_value;
+            return ss.str();
+        }
+        case DataType::TEXT:
+        default:
+            return text_value;
+    }
+}
+
+int TypedValue::compare(const TypedValue& other) const {
+    switch (type) {
+        case DataType::INT:
+        case DataType::BOOL:
+            return (int_value < other.int_value) ? -1 : (int_value > other.int_value ? 1 : 0);
+        case DataType::FLOAT:
+            return (float_value < other.float_value) ? -1 : (float_value > other.float_value ? 1 : 0);
+        case DataType::TEXT:
+        default: {
+            int cmp = text_value.compare(other.text_value);
+            return (cmp < 0) ? -1 : (cmp > 0 ? 1 : 0);
+        }
+    }
+}
+
+bool CompositeKeyLess::operator()(const CompositeKey& a, const CompositeKey& b) const {
+    size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) {
+        int cmp = a[i].compare(b[i]);
+        if (cmp != 0) {
+            bool desc = i < descending.size() && descending[i];
+            return desc ? cmp > 0 : cmp < 0;
+        }
+    }
+    return a.size() < b.size();
+}
+
+} // namespace vsdb
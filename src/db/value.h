@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vsdb {
+
+enum class DataType {
+    INT,
+    FLOAT,
+    TEXT,
+    BOOL
+};
+
+// A stored string value interpreted according to its column type.
+// Values of the same type order numerically (INT, FLOAT, BOOL) or
+// lexicographically (TEXT).
+struct TypedValue {
+    DataType type = DataType::TEXT;
+    int64_t int_value = 0;
+    double float_value = 0.0;
+    std::string text_value;
+    
+    static TypedValue parse(DataType type, const std::string& raw);
+    std::string to_string() const;
+    
+    int compare(const TypedValue& other) const;
+    
+    bool operator<(const TypedValue& other) const { return compare(other) < 0; }
+    bool operator>(const TypedValue& other) const { return compare(other) > 0; }
+    bool operator==(const TypedValue& other) const { return compare(other) == 0; }
+    bool operator!=(const TypedValue& other) const { return compare(other) != 0; }
+};
+
+// Key over several columns, one value per column
+using CompositeKey = std::vector<TypedValue>;
+
+// Orders composite keys column by column, each ascending unless marked
+// descending. A shorter key that matches the start of a longer one sorts
+// first, so a key prefix bounds a range scan.
+struct CompositeKeyLess {
+    std::vector<bool> descending;
+    
+    bool operator()(const CompositeKey& a, const CompositeKey& b) const;
+};
+
+} // namespace vsdb
@@ -1,20 +1,138 @@
 #include "gitstore/gitstore.h"
+#include "util/atomic_file.h"
+#include "util/metrics.h"
+#include "util/sha256.h"
+#include "util/trace.h"
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
-#include <iostream>
+#include <algorithm>
+#include <unordered_map>
 
 namespace vsdb {
 
 GitStore::GitStore(const std::filesystem::path& objects_dir) 
-    : objects_dir_(objects_dir), head_file_(objects_dir.parent_path() / ".vsdb_head") {
+    : objects_dir_(objects_dir),
+      head_file_(objects_dir.parent_path() / ".vsdb_head"),
+      ids_file_(objects_dir / "ids"),
+      worktrees_file_(objects_dir.parent_path() / ".vsdb_worktrees"),
+      fsck_file_(objects_dir.parent_path() / ".vsdb_fsck"),
+      tips_file_(objects_dir.parent_path() / ".vsdb_tips") {
     std::filesystem::create_directories(objects_dir_);
 }
 
+std::filesystem::path GitStore::object_path(const std::string& hash) const {
+    if (hash.size() <= 2) {
+        return objects_dir_ / hash;
+    }
+    return objects_dir_ / hash.substr(0, 2) / hash.substr(2);
+}
+
+std::optional<std::filesystem::path> GitStore::find_object(const std::string& hash) const {
+    if (hash.empty()) {
+        return std::nullopt;
+    }
+    
+    std::filesystem::path sharded = object_path(hash);
+    if (std::filesystem::exists(sharded)) {
+        return sharded;
+    }
+    
+    std::filesystem::path flat = objects_dir_ / hash;
+    if (hash != "ids" && std::filesystem::is_regular_file(flat)) {
+        return flat;
+    }
+    return std::nullopt;
+}
+
+void GitStore::load_known_objects() {
+    if (known_loaded_) return;
+    known_loaded_ = true;
+    
+    std::ifstream ids(ids_file_);
+    if (ids.is_open()) {
+        std::string id;
+        while (std::getline(ids, id)) {
+            if (!id.empty()) known_objects_.insert(id);
+        }
+        return;
+    }
+    
+    // No id list yet: collect ids from both layouts once
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(objects_dir_)) {
+        if (entry.is_regular_file() && entry.path() != ids_file_) {
+            known_objects_.insert(object_id(entry.path()));
+        }
+    }
+    
+    std::ofstream out(ids_file_);
+    for (const auto& id : known_objects_) {
+        out << id << "\n";
+    }
+}
+
+std::string GitStore::object_id(const std::filesystem::path& file) const {
+    std::filesystem::path parent = file.parent_path();
+    std::string name = file.filename().string();
+    return parent == objects_dir_ ? name : parent.filename().string() + name;
+}
+
+bool GitStore::rewrite_known_objects(std::unordered_set<std::string> ids) {
+    ids_out_.close();
+    
+    bool written = replace_file(ids_file_, [&](const std::filesystem::path& tmp_path) {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out.is_open()) return false;
+        for (const auto& id : ids) {
+            out << id << "\n";
+        }
+        return static_cast<bool>(out.flush());
+    });
+    if (!written) return false;
+    
+    known_objects_ = std::move(ids);
+    known_loaded_ = true;
+    return true;
+}
+
+bool GitStore::has_object(const std::string& hash) {
+    load_known_objects();
+    return known_objects_.count(hash) > 0;
+}
+
+bool GitStore::write_object(const std::string& hash, const std::string& content) {
+    TraceSpan span("write_object");
+    load_known_objects();
+    
+    std::filesystem::path obj_path = object_path(hash);
+    std::error_code ec;
+    std::filesystem::create_directories(obj_path.parent_path(), ec);
+    
+    {
+        std::ofstream dst(obj_path, std::ios::binary);
+        if (!dst.is_open()) return false;
+        dst << content;
+        if (!dst.flush()) return false;
+    }
+    
+    // Record the id only once the object is on disk
+    if (!ids_out_.is_open()) {
+        ids_out_.open(ids_file_, std::ios::app);
+    }
+    ids_out_ << hash << "\n";
+    ids_out_.flush();
+    
+    known_objects_.insert(hash);
+    return true;
+}
+
 std::string GitStore::generate_hash(const std::string& content) {
-    // Simple hash function (not cryptographic)
-    // In production, use SHA-1 or SHA-256
+    ScopedTimer timer(Timer::GENERATE_HASH);
+    return Sha256::hex(content);
+}
+
+std::string GitStore::legacy_hash(const std::string& content) {
     std::hash<std::string> hasher;
     size_t hash_value = hasher(content);
     
@@ -35,41 +153,70 @@ std::string GitStore::hash_file(const std::filesystem::path& file_path) {
 }
 
 std::string GitStore::store_file(const std::filesystem::path& file_path) {
-    std::ifstream src(file_path, std::ios::binary);
-    if (!src.is_open()) {
-        return "";
+    ScopedTimer timer(Timer::STORE_FILE);
+    timer.span().annotate_file(file_path);
+    
+    std::string content;
+    {
+        TraceSpan span("read_file");
+        std::ifstream src(file_path, std::ios::binary);
+        if (!src.is_open()) {
+            return "";
+        }
+        
+        std::stringstream buffer;
+        buffer << src.rdbuf();
+        content = buffer.str();
     }
-    
-    std::stringstream buffer;
-    buffer << src.rdbuf();
-    std::string content = buffer.str();
+    Metrics::instance().add(Counter::BYTES_READ, content.size());
     
     std::string hash = generate_hash(content);
-    std::filesystem::path obj_path = objects_dir_ / hash;
     
     // Don't store if already exists
-    if (std::filesystem::exists(obj_path)) {
+    if (has_object(hash)) {
+        Metrics::instance().add(Counter::OBJECTS_DEDUPLICATED);
         return hash;
     }
     
-    std::ofstream dst(obj_path, std::ios::binary);
-    dst << content;
+    if (!write_object(hash, content)) {
+        return "";
+    }
+    
+    Metrics::instance().add(Counter::OBJECTS_STORED);
+    Metrics::instance().add(Counter::BYTES_WRITTEN, content.size());
     
     return hash;
 }
 
-bool GitStore::restore_file(const std::string& hash, const std::filesystem::path& target_path) {
-    std::filesystem::path obj_path = objects_dir_ / hash;
+bool GitStore::restore_file(const std::string& hash, const std::filesystem::path& target_path, bool link) {
+    ScopedTimer timer(Timer::RESTORE_FILE);
+    timer.span().annotate_file(target_path);
     
-    if (!std::filesystem::exists(obj_path)) {
-        std::cerr << "Error: Object " << hash << " not found\n";
+    auto obj_path = find_object(hash);
+    if (!obj_path) {
         return false;
     }
     
-    std::ifstream src(obj_path, std::ios::binary);
+    // Objects are immutable, so a link shares their bytes safely as long
+    // as the target is only read
+    if (link) {
+        std::error_code ec;
+        std::filesystem::create_hard_link(*obj_path, target_path, ec);
+        if (!ec) {
+            Metrics::instance().add(Counter::OBJECTS_RESTORED);
+            return true;
+        }
+    }
+    
+    std::ifstream src(*obj_path, std::ios::binary);
     std::ofstream dst(target_path, std::ios::binary);
     
     dst << src.rdbuf();
+    
+    auto bytes = std::filesystem::file_size(*obj_path);
+    Metrics::instance().add(Counter::OBJECTS_RESTORED);
+    Metrics::instance().add(Counter::BYTES_READ, bytes);
+    Metrics::instance().add(Counter::BYTES_WRITTEN, bytes);
     return true;
 }
 
@@ -79,6 +226,12 @@ std::string Commit::serialize() const {
     ss << "message=" << message << "\n";
     ss << "timestamp=" << timestamp << "\n";
     ss << "parent=" << parent_hash << "\n";
+    if (!tree_root.empty()) {
+        ss << "root=" << tree_root << "\n";
+        for (const auto& row_root : row_roots) {
+            ss << "rows=" << row_root << "\n";
+        }
+    }
     ss << "files=" << file_hashes.size() << "\n";
     
     for (const auto& fh : file_hashes) {
@@ -113,6 +266,10 @@ Commit Commit::deserialize(const std::string& data) {
             commit.timestamp = value;
         } else if (key == "parent") {
             commit.parent_hash = value;
+        } else if (key == "root") {
+            commit.tree_root = value;
+        } else if (key == "rows") {
+            commit.row_roots.push_back(value);
         } else if (key == "files") {
             // Next lines are file hashes
         }
@@ -121,26 +278,34 @@ Commit Commit::deserialize(const std::string& data) {
     return commit;
 }
 
-bool GitStore::save_commit(const Commit& commit) {
-    std::filesystem::path commit_path = objects_dir_ / commit.hash;
-    std::ofstream file(commit_path);
-    
-    if (!file.is_open()) {
-        return false;
+std::vector<std::string> Commit::tree_leaves() const {
+    std::vector<std::string> leaves;
+    leaves.reserve(file_hashes.size() + row_roots.size());
+    for (const auto& file_hash : file_hashes) {
+        leaves.push_back("file:" + file_hash);
     }
-    
-    file << commit.serialize();
-    return true;
+    for (const auto& row_root : row_roots) {
+        leaves.push_back("rows:" + row_root);
+    }
+    std::sort(leaves.begin(), leaves.end());
+    return leaves;
+}
+
+std::string Commit::header() const {
+    return "parent=" + parent_hash + "\nmessage=" + message + "\ntimestamp=" + timestamp + "\n";
+}
+
+bool GitStore::save_commit(const Commit& commit) {
+    return write_object(commit.hash, commit.serialize());
 }
 
 std::optional<Commit> GitStore::load_commit(const std::string& hash) const {
-    std::filesystem::path commit_path = objects_dir_ / hash;
-    
-    if (!std::filesystem::exists(commit_path)) {
+    auto commit_path = find_object(hash);
+    if (!commit_path) {
         return std::nullopt;
     }
     
-    std::ifstream file(commit_path);
+    std::ifstream file(*commit_path);
     std::stringstream buffer;
     buffer << file.rdbuf();
     
@@ -169,7 +334,60 @@ std::optional<std::string> GitStore::get_head() const {
     return hash.empty() ? std::nullopt : std::make_optional(hash);
 }
 
-std::string GitStore::commit(const std::string& message, const std::filesystem::path& data_dir) {
+std::optional<std::vector<std::string>> GitStore::get_tips() const {
+    std::vector<std::string> tips;
+    std::ifstream file(tips_file_);
+    if (file.is_open()) {
+        std::string hash;
+        while (std::getline(file, hash)) {
+            if (!hash.empty()) tips.push_back(hash);
+        }
+        return tips;
+    }
+    
+    // Stores from before the tip list: every commit that is nobody's parent
+    std::vector<std::string> commits;
+    std::unordered_set<std::string> parents;
+    std::error_code ec;
+    for (std::filesystem::recursive_directory_iterator it(objects_dir_, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file() || it->path() == ids_file_) continue;
+        
+        std::ifstream object(it->path());
+        char prefix[5] = {};
+        if (!object.read(prefix, sizeof(prefix)) || std::string(prefix, sizeof(prefix)) != "hash=") continue;
+        
+        std::string id = object_id(it->path());
+        if (auto commit = load_commit(id); commit && commit->hash == id) {
+            commits.push_back(id);
+            parents.insert(commit->parent_hash);
+        }
+    }
+    if (ec) {
+        return std::nullopt;
+    }
+    
+    for (const auto& hash : commits) {
+        if (!parents.count(hash)) tips.push_back(hash);
+    }
+    std::sort(tips.begin(), tips.end());
+    return tips;
+}
+
+bool GitStore::write_tips(const std::vector<std::string>& tips) {
+    return replace_file(tips_file_, [&](const std::filesystem::path& tmp_path) {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out.is_open()) return false;
+        for (const auto& hash : tips) {
+            out << hash << "\n";
+        }
+        return static_cast<bool>(out.flush());
+    });
+}
+
+std::string GitStore::commit(const std::string& message, const std::filesystem::path& data_dir,
+                             const std::vector<std::string>& row_roots) {
+    ScopedTimer timer(Timer::COMMIT);
+    
     Commit new_commit;
     new_commit.message = message;
     
@@ -185,32 +403,59 @@ std::string GitStore::commit(const std::string& message, const std::filesystem::
     new_commit.parent_hash = head.value_or("");
     
     // Store all data files
-    for (const auto& entry : std::filesystem::directory_iterator(data_dir)) {
-        if (entry.is_regular_file()) {
-            std::string hash = store_file(entry.path());
-            if (!hash.empty()) {
-                new_commit.file_hashes.push_back(entry.path().filename().string() + ":" + hash);
+    std::vector<std::filesystem::path> files;
+    {
+        TraceSpan span("list_data_dir");
+        for (const auto& entry : std::filesystem::directory_iterator(data_dir)) {
+            auto ext = entry.path().extension();
+            if (entry.is_regular_file() && ext != ".tmp" && ext != ".compact") {
+                files.push_back(entry.path());
             }
         }
     }
-    
-    // Generate commit hash
-    std::string commit_content = new_commit.message + new_commit.timestamp + new_commit.parent_hash;
-    for (const auto& fh : new_commit.file_hashes) {
-        commit_content += fh;
+    for (const auto& file : files) {
+        std::string hash = store_file(file);
+        if (!hash.empty()) {
+            new_commit.file_hashes.push_back(file.filename().string() + ":" + hash);
+        }
     }
-    new_commit.hash = generate_hash(commit_content);
+    
+    new_commit.row_roots = row_roots;
+    std::sort(new_commit.row_roots.begin(), new_commit.row_roots.end());
+    new_commit.tree_root = MerkleTree(new_commit.tree_leaves()).root();
+    new_commit.hash = commit_hash(new_commit);
     
     // Save commit and update HEAD
     if (!save_commit(new_commit)) {
         return "";
     }
     
+    // The new commit replaces its parent as the tip of its line
+    std::vector<std::string> tips = get_tips().value_or(std::vector<std::string>());
+    tips.erase(std::remove(tips.begin(), tips.end(), new_commit.parent_hash), tips.end());
+    tips.push_back(new_commit.hash);
+    if (!write_tips(tips)) {
+        return "";
+    }
+    
     update_head(new_commit.hash);
     
     return new_commit.hash;
 }
 
+std::string GitStore::commit_hash(const Commit& commit) {
+    // The root is recomputed, so a matching hash vouches for every leaf
+    if (!commit.tree_root.empty()) {
+        return generate_hash(commit.header() + "root=" + MerkleTree(commit.tree_leaves()).root() + "\n");
+    }
+    
+    std::string commit_content = commit.message + commit.timestamp + commit.parent_hash;
+    for (const auto& fh : commit.file_hashes) {
+        commit_content += fh;
+    }
+    return legacy_hash(commit_content);
+}
+
 std::vector<Commit> GitStore::get_log() const {
     std::vector<Commit> log;
     
@@ -234,37 +479,456 @@ std::vector<Commit> GitStore::get_log() const {
     return log;
 }
 
-bool GitStore::checkout(const std::string& commit_hash, const std::filesystem::path& data_dir) {
+Status GitStore::checkout(const std::string& commit_hash, const std::filesystem::path& data_dir) {
+    ScopedTimer timer(Timer::CHECKOUT);
+    
     auto commit = load_commit(commit_hash);
     if (!commit) {
-        std::cerr << "Error: Commit " << commit_hash << " not found\n";
-        return false;
+        return Status::error("Commit " + commit_hash + " not found");
     }
     
     // Clear data directory
-    for (const auto& entry : std::filesystem::directory_iterator(data_dir)) {
-        if (entry.is_regular_file()) {
-            std::filesystem::remove(entry.path());
+    {
+        TraceSpan span("clear_data_dir");
+        for (const auto& entry : std::filesystem::directory_iterator(data_dir)) {
+            if (entry.is_regular_file()) {
+                std::filesystem::remove(entry.path());
+            }
         }
     }
     
     // Restore all files from commit
-    for (const auto& file_hash : commit->file_hashes) {
+    Status status = restore_files(*commit, data_dir, [](const std::string&) { return true; });
+    
+    // Update HEAD
+    update_head(commit_hash);
+    
+    if (!status) {
+        return Status::error("Checked out " + commit_hash + " but " + status.message());
+    }
+    return Status::ok();
+}
+
+std::optional<Commit> GitStore::get_commit(const std::string& hash) const {
+    return load_commit(hash);
+}
+
+Status GitStore::restore_files(const Commit& commit, const std::filesystem::path& dir,
+                               const std::function<bool(const std::string& filename)>& include,
+                               bool link) {
+    std::vector<std::string> missing;
+    for (const auto& file_hash : commit.file_hashes) {
         size_t colon_pos = file_hash.find(':');
         if (colon_pos == std::string::npos) continue;
         
         std::string filename = file_hash.substr(0, colon_pos);
         std::string hash = file_hash.substr(colon_pos + 1);
         
-        if (!restore_file(hash, data_dir / filename)) {
-            std::cerr << "Warning: Failed to restore " << filename << "\n";
+        if (include(filename) && !restore_file(hash, dir / filename, link)) {
+            missing.push_back(filename);
         }
     }
     
-    // Update HEAD
-    update_head(commit_hash);
+    if (!missing.empty()) {
+        std::string files;
+        for (const auto& filename : missing) {
+            files += (files.empty() ? "" : ", ") + filename;
+        }
+        return Status::error("failed to restore " + files);
+    }
+    return Status::ok();
+}
+
+std::vector<WorktreeRef> GitStore::get_worktrees() const {
+    std::vector<WorktreeRef> worktrees;
+    std::ifstream file(worktrees_file_);
     
-    return true;
+    // One "<commit> <dir>" line per worktree
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t space = line.find(' ');
+        if (space == std::string::npos) continue;
+        worktrees.push_back({line.substr(0, space), line.substr(space + 1)});
+    }
+    return worktrees;
+}
+
+bool GitStore::write_worktrees(const std::vector<WorktreeRef>& worktrees) {
+    return replace_file(worktrees_file_, [&](const std::filesystem::path& tmp_path) {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out.is_open()) return false;
+        for (const auto& worktree : worktrees) {
+            out << worktree.commit << " " << worktree.dir.string() << "\n";
+        }
+        return static_cast<bool>(out.flush());
+    });
+}
+
+Status GitStore::add_worktree(const WorktreeRef& worktree) {
+    auto worktrees = get_worktrees();
+    worktrees.push_back(worktree);
+    if (!write_worktrees(worktrees)) {
+        return Status::error("Failed to register worktree " + worktree.dir.string());
+    }
+    return Status::ok();
+}
+
+Status GitStore::remove_worktree(const std::filesystem::path& dir) {
+    auto worktrees = get_worktrees();
+    auto it = std::find_if(worktrees.begin(), worktrees.end(),
+                           [&](const WorktreeRef& worktree) { return worktree.dir == dir; });
+    if (it == worktrees.end()) {
+        return Status::error("No worktree at " + dir.string());
+    }
+    
+    worktrees.erase(it);
+    if (!write_worktrees(worktrees)) {
+        return Status::error("Failed to unregister worktree " + dir.string());
+    }
+    return Status::ok();
+}
+
+ObjectStoreStats GitStore::get_stats() const {
+    ObjectStoreStats stats;
+    
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(objects_dir_)) {
+        if (entry.is_regular_file() && entry.path() != ids_file_) {
+            stats.object_count++;
+            stats.total_bytes += entry.file_size();
+        }
+    }
+    
+    stats.commit_count = get_log().size();
+    return stats;
+}
+
+bool GitStore::verify_object(const std::string& id, const std::filesystem::path& file) const {
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string content = buffer.str();
+    Metrics::instance().add(Counter::BYTES_READ, content.size());
+    Metrics::instance().add(Counter::OBJECTS_VERIFIED);
+    
+    // Commits are stored under their commit hash rather than a hash of
+    // their contents
+    if (content.compare(0, id.size() + 6, "hash=" + id + "\n") == 0) {
+        Commit commit = Commit::deserialize(content);
+        if (commit_hash(commit) == id &&
+            (commit.tree_root.empty() || commit.tree_root == MerkleTree(commit.tree_leaves()).root())) {
+            return true;
+        }
+    }
+    
+    return (id.size() == 64 ? generate_hash(content) : legacy_hash(content)) == id;
+}
+
+namespace {
+
+// Size and modification time; objects are immutable, so any change
+// means the file was rewritten
+std::string file_signature(const std::filesystem::path& file) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(file, ec);
+    auto mtime = std::filesystem::last_write_time(file, ec);
+    return std::to_string(size) + " " + std::to_string(mtime.time_since_epoch().count());
+}
+
+} // namespace
+
+Status GitStore::fsck(const FsckOptions& options, FsckReport* report) {
+    *report = FsckReport();
+    
+    // "<id> <size> <mtime>" for each object that passed the last check
+    std::unordered_map<std::string, std::string> verified;
+    if (!options.full) {
+        std::ifstream cache(fsck_file_);
+        std::string line;
+        while (std::getline(cache, line)) {
+            size_t space = line.find(' ');
+            if (space != std::string::npos) {
+                verified[line.substr(0, space)] = line.substr(space + 1);
+            }
+        }
+    }
+    
+    struct Object {
+        std::string id;
+        std::filesystem::path file;
+        std::string signature;
+    };
+    std::vector<Object> unchanged;
+    std::vector<Object> pending;
+    std::unordered_set<std::string> present;
+    
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(objects_dir_)) {
+        if (!entry.is_regular_file() || entry.path() == ids_file_) continue;
+        
+        Object object{object_id(entry.path()), entry.path(), file_signature(entry.path())};
+        present.insert(object.id);
+        
+        auto it = verified.find(object.id);
+        if (it != verified.end() && it->second == object.signature) {
+            unchanged.push_back(std::move(object));
+        } else {
+            pending.push_back(std::move(object));
+        }
+    }
+    
+    // Objects are independent, so each task rehashes its own range
+    std::vector<char> valid(pending.size(), 0);
+    size_t threads = std::max<size_t>(1, std::min(options.threads, pending.size()));
+    if (threads == 1) {
+        for (size_t i = 0; i < pending.size(); ++i) {
+            valid[i] = verify_object(pending[i].id, pending[i].file);
+        }
+    } else {
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> tasks;
+        for (const auto& [begin, end] : partition_range(pending.size(), threads * 4)) {
+            tasks.push_back(pool.submit([&, begin = begin, end = end]() {
+                for (size_t i = begin; i < end; ++i) {
+                    valid[i] = verify_object(pending[i].id, pending[i].file);
+                }
+            }));
+        }
+        for (auto& task : tasks) {
+            task.get();
+        }
+    }
+    
+    report->objects_checked = pending.size();
+    report->objects_skipped = unchanged.size();
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (valid[i]) {
+            unchanged.push_back(std::move(pending[i]));
+        } else {
+            report->corrupt.push_back(pending[i].id);
+        }
+    }
+    std::sort(report->corrupt.begin(), report->corrupt.end());
+    
+    // Walk the history prune keeps: from HEAD, every tip and every worktree
+    std::vector<std::string> roots;
+    if (auto head = get_head()) {
+        roots.push_back(*head);
+    }
+    for (const auto& tip : get_tips().value_or(std::vector<std::string>())) {
+        roots.push_back(tip);
+    }
+    for (const auto& worktree : get_worktrees()) {
+        roots.push_back(worktree.commit);
+    }
+    
+    std::unordered_set<std::string> seen;
+    for (const auto& root : roots) {
+        for (std::string hash = root; !hash.empty() && seen.insert(hash).second;) {
+            auto commit = present.count(hash) ? load_commit(hash) : std::nullopt;
+            if (!commit) {
+                report->missing.push_back("commit " + hash);
+                break;
+            }
+            report->commits_checked++;
+            
+            for (const auto& file_hash : commit->file_hashes) {
+                size_t colon_pos = file_hash.find(':');
+                if (colon_pos == std::string::npos) continue;
+                if (!present.count(file_hash.substr(colon_pos + 1))) {
+                    report->missing.push_back(file_hash.substr(0, colon_pos) + " " +
+                                              file_hash.substr(colon_pos + 1) + " in commit " + hash);
+                }
+            }
+            hash = commit->parent_hash;
+        }
+    }
+    
+    // Corrupt objects stay out of the cache and are rehashed next time
+    bool written = replace_file(fsck_file_, [&](const std::filesystem::path& tmp_path) {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out.is_open()) return false;
+        for (const auto& object : unchanged) {
+            out << object.id << " " << object.signature << "\n";
+        }
+        return static_cast<bool>(out.flush());
+    });
+    if (!written) {
+        return Status::error("Failed to write " + fsck_file_.string());
+    }
+    return Status::ok();
+}
+
+namespace {
+
+// Age of a commit timestamp ("%Y-%m-%d %H:%M:%S", local time) in days
+std::optional<double> age_in_days(const std::string& timestamp) {
+    std::tm tm = {};
+    std::istringstream ss(timestamp);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    if (ss.fail()) {
+        return std::nullopt;
+    }
+    
+    tm.tm_isdst = -1;
+    std::time_t then = std::mktime(&tm);
+    std::time_t now = std::time(nullptr);
+    return std::difftime(now, then) / (24 * 60 * 60);
+}
+
+} // namespace
+
+Status GitStore::prune(const RetentionPolicy& policy, bool dry_run, PruneStats* stats) {
+    *stats = PruneStats();
+    std::vector<Commit> chain = get_log(); // Newest first
+    
+    // A checkout of an older commit leaves newer ones only reachable from
+    // their tip; without the tips they would be swept
+    auto tips = get_tips();
+    auto head = get_head();
+    bool detached = head && (!tips || std::find(tips->begin(), tips->end(), *head) == tips->end());
+    if (detached && !tips) {
+        return Status::error("HEAD is detached and the newest commit cannot be determined; "
+                             "checkout the newest commit before pruning");
+    }
+    
+    // Kept commits form a prefix of the chain; HEAD is always kept
+    size_t keep = chain.size();
+    if (policy.keep_last || policy.keep_days) {
+        keep = 0;
+        for (size_t i = 0; i < chain.size(); ++i) {
+            bool by_count = policy.keep_last && i < *policy.keep_last;
+            bool by_age = false;
+            if (policy.keep_days) {
+                auto age = age_in_days(chain[i].timestamp);
+                by_age = !age || *age <= static_cast<double>(*policy.keep_days);
+            }
+            if (!by_count && !by_age) break;
+            keep = i + 1;
+        }
+        keep = std::max<size_t>(keep, std::min<size_t>(chain.size(), 1));
+    }
+    
+    stats->commits_kept = keep;
+    stats->commits_squashed = chain.size() - keep;
+    if (stats->commits_squashed > 0 && detached) {
+        return Status::error("HEAD is behind newer commits; checkout the newest commit before squashing history");
+    }
+    chain.resize(keep);
+    
+    // The oldest kept commit becomes the root; its snapshot already holds
+    // every file, so only the hashes above it change
+    if (stats->commits_squashed > 0) {
+        std::string parent;
+        for (size_t i = chain.size(); i-- > 0;) {
+            chain[i].parent_hash = parent;
+            chain[i].hash = commit_hash(chain[i]);
+            parent = chain[i].hash;
+        }
+    }
+    stats->head = chain.empty() ? "" : chain.front().hash;
+    
+    std::unordered_set<std::string> reachable;
+    auto mark = [&](const Commit& commit) {
+        reachable.insert(commit.hash);
+        for (const auto& file_hash : commit.file_hashes) {
+            size_t colon_pos = file_hash.find(':');
+            if (colon_pos != std::string::npos) {
+                reachable.insert(file_hash.substr(colon_pos + 1));
+            }
+        }
+    };
+    
+    // Other tips and worktree commits keep their whole history
+    auto mark_history = [&](const std::string& root) {
+        for (std::string hash = root; !hash.empty() && !reachable.count(hash);) {
+            auto commit = load_commit(hash);
+            if (!commit) break;
+            mark(*commit);
+            hash = commit->parent_hash;
+        }
+    };
+    
+    // Mark
+    for (const auto& commit : chain) {
+        mark(commit);
+    }
+    for (const auto& tip : tips.value_or(std::vector<std::string>())) {
+        if (tip != head) mark_history(tip);
+    }
+    
+    std::vector<WorktreeRef> worktrees;
+    bool dropped_worktrees = false;
+    for (const auto& worktree : get_worktrees()) {
+        if (!std::filesystem::exists(worktree.dir)) {
+            dropped_worktrees = true;
+            continue;
+        }
+        worktrees.push_back(worktree);
+        mark_history(worktree.commit);
+    }
+    
+    // Publish the rewritten history before anything is deleted
+    if (!dry_run && stats->commits_squashed > 0) {
+        for (const auto& commit : chain) {
+            if (!has_object(commit.hash) && !save_commit(commit)) {
+                return Status::error("Failed to write commit " + commit.hash);
+            }
+        }
+        if (!update_head(stats->head)) {
+            return Status::error("Failed to update HEAD");
+        }
+        
+        std::replace(tips->begin(), tips->end(), *head, stats->head);
+        if (!write_tips(*tips)) {
+            return Status::error("Failed to update the tip list");
+        }
+    }
+    
+    if (!dry_run && dropped_worktrees && !write_worktrees(worktrees)) {
+        return Status::error("Failed to update the worktree list");
+    }
+    
+    // Sweep
+    std::vector<std::filesystem::path> garbage;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(objects_dir_)) {
+        if (!entry.is_regular_file() || entry.path() == ids_file_) continue;
+        if (reachable.count(object_id(entry.path()))) continue;
+        
+        stats->objects_removed++;
+        stats->bytes_freed += entry.file_size();
+        garbage.push_back(entry.path());
+    }
+    
+    if (dry_run) {
+        return Status::ok();
+    }
+    
+    std::error_code ec;
+    for (const auto& path : garbage) {
+        std::filesystem::remove(path, ec);
+        if (ec) {
+            return Status::error("Failed to remove " + path.string() + ": " + ec.message());
+        }
+        
+        std::filesystem::path dir = path.parent_path();
+        if (dir != objects_dir_ && std::filesystem::is_empty(dir, ec)) {
+            std::filesystem::remove(dir, ec);
+        }
+    }
+    Metrics::instance().add(Counter::OBJECTS_PRUNED, garbage.size());
+    
+    std::unordered_set<std::string> remaining;
+    for (const auto& id : reachable) {
+        if (find_object(id)) remaining.insert(id);
+    }
+    if (!rewrite_known_objects(std::move(remaining))) {
+        return Status::error("Failed to rewrite the object id list");
+    }
+    
+    return Status::ok();
 }
 
-} // namespace vsdb
\ No newline at end of file
+} // namespace vsdb
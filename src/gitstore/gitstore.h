@@ -4,7 +4,13 @@
 #include <vector>
 #include <filesystem>
 #include <ctime>
+#include <fstream>
+#include <functional>
 #include <optional>
+#include <unordered_set>
+#include "gitstore/merkle.h"
+#include "util/status.h"
+#include "util/thread_pool.h"
 
 namespace vsdb {
 
@@ -14,30 +20,156 @@ struct Commit {
     std::string timestamp;
     std::string parent_hash;
     std::vector<std::string> file_hashes; // Hashes of all data files
+    std::string tree_root;                // Empty for commits made before Merkle trees
+    std::vector<std::string> row_roots;   // "<table>:<root of its row hashes>"
+    
+    // Leaves of the commit's tree: "file:<name>:<hash>" and
+    // "rows:<table>:<root>", sorted
+    std::vector<std::string> tree_leaves() const;
+    // Everything hashed into the commit id besides the tree root
+    std::string header() const;
     
     std::string serialize() const;
     static Commit deserialize(const std::string& data);
 };
 
+struct ObjectStoreStats {
+    size_t object_count = 0;
+    uintmax_t total_bytes = 0;
+    size_t commit_count = 0; // Commits reachable from HEAD
+};
+
+// Which commits `prune` keeps; older history is squashed into a base
+// commit. With neither limit set, all history is kept.
+struct RetentionPolicy {
+    std::optional<size_t> keep_last;  // Newest commits to keep
+    std::optional<size_t> keep_days;  // Keep commits younger than this
+};
+
+// A directory holding a commit's files as links into the object store
+struct WorktreeRef {
+    std::string commit;
+    std::filesystem::path dir;
+};
+
+struct FsckOptions {
+    bool full = false; // Rehash objects already verified unchanged
+    size_t threads = ThreadPool::default_threads();
+};
+
+struct FsckReport {
+    size_t objects_checked = 0;
+    size_t objects_skipped = 0;        // Verified by an earlier run and unchanged since
+    size_t commits_checked = 0;        // Reachable from HEAD, a tip or a worktree
+    std::vector<std::string> corrupt;  // Objects whose contents do not match their id
+    std::vector<std::string> missing;  // Referenced objects that do not exist
+    
+    bool ok() const { return corrupt.empty() && missing.empty(); }
+};
+
+struct PruneStats {
+    size_t commits_kept = 0;
+    size_t commits_squashed = 0;  // Folded into the oldest kept commit
+    size_t objects_removed = 0;
+    uintmax_t bytes_freed = 0;
+    std::string head;             // HEAD after history was rewritten
+};
+
+// Content-addressed object store. Objects live in hash-prefix fan-out
+// directories (objects/ab/cdef...); objects/ids lists every stored id so
+// existence checks are answered from memory. Ids are SHA-256 digests;
+// objects written by older versions under 16-digit legacy ids, or at
+// objects/<hash>, are still found.
 class GitStore {
 public:
     GitStore(const std::filesystem::path& objects_dir);
     
-    // Create a new commit with current database state
-    std::string commit(const std::string& message, const std::filesystem::path& data_dir);
+    // Create a new commit with current database state. The commit hash is
+    // the root of a Merkle tree over the files and `row_roots`. Files
+    // still being written (.tmp) or staged by a compaction (.compact) are
+    // left out.
+    std::string commit(const std::string& message, const std::filesystem::path& data_dir,
+                       const std::vector<std::string>& row_roots = {});
     
     // Get commit history
     std::vector<Commit> get_log() const;
     
     // Restore database to a specific commit
-    bool checkout(const std::string& commit_hash, const std::filesystem::path& data_dir);
+    Status checkout(const std::string& commit_hash, const std::filesystem::path& data_dir);
     
     // Get current HEAD commit
     std::optional<std::string> get_head() const;
     
+    std::optional<Commit> get_commit(const std::string& hash) const;
+    
+    // Copy the files of a commit accepted by `include` into `dir`,
+    // leaving HEAD and other files alone. With `link` the files are hard
+    // links to the objects (copied only where linking fails) and must
+    // never be written to.
+    Status restore_files(const Commit& commit, const std::filesystem::path& dir,
+                         const std::function<bool(const std::string& filename)>& include,
+                         bool link = false);
+    
+    // Registered worktrees; their commits are kept by prune
+    std::vector<WorktreeRef> get_worktrees() const;
+    Status add_worktree(const WorktreeRef& worktree);
+    Status remove_worktree(const std::filesystem::path& dir);
+    
+    // Rehash objects in parallel and check every reachable commit and the
+    // objects it references. Objects whose size and mtime match the last
+    // successful check are skipped unless `full` is set.
+    Status fsck(const FsckOptions& options, FsckReport* report);
+    
+    // Hash of object contents; commits made before Merkle trees use the
+    // short legacy hash
+    static std::string generate_hash(const std::string& content);
+    static std::string legacy_hash(const std::string& content);
+    
+    // Hash over a commit's header and tree, or the legacy hash over its
+    // message, timestamp, parent and files
+    static std::string commit_hash(const Commit& commit);
+    
+    // Summarize the objects directory
+    ObjectStoreStats get_stats() const;
+    
+    // Apply the retention policy, then delete every object not reachable
+    // from HEAD, the newest commit of each line of history or a worktree.
+    // Squashing rewrites the hashes of the kept commits and is refused
+    // while HEAD is checked out behind the newest commit. Worktrees whose
+    // directory is gone are unregistered. With `dry_run` only the
+    // statistics are computed.
+    Status prune(const RetentionPolicy& policy, bool dry_run, PruneStats* stats);
+    
 private:
     std::filesystem::path objects_dir_;
     std::filesystem::path head_file_;
+    std::filesystem::path ids_file_;
+    std::filesystem::path worktrees_file_;
+    std::filesystem::path fsck_file_;
+    std::filesystem::path tips_file_;
+    
+    std::unordered_set<std::string> known_objects_;
+    bool known_loaded_ = false;
+    std::ofstream ids_out_;
+    
+    // Path an object is written to: objects/<2 hex>/<rest>
+    std::filesystem::path object_path(const std::string& hash) const;
+    
+    // Existing file of an object, in either layout
+    std::optional<std::filesystem::path> find_object(const std::string& hash) const;
+    
+    // Read objects/ids, or rebuild it by walking objects/ if missing
+    void load_known_objects();
+    bool has_object(const std::string& hash);
+    
+    // Write an object and record its id
+    bool write_object(const std::string& hash, const std::string& content);
+    
+    // Object id of a file under objects/, in either layout
+    std::string object_id(const std::filesystem::path& file) const;
+    
+    // Replace objects/ids with exactly these ids
+    bool rewrite_known_objects(std::unordered_set<std::string> ids);
     
     // Hash a file's contents
     std::string hash_file(const std::filesystem::path& file_path);
@@ -46,7 +178,9 @@ private:
     std::string store_file(const std::filesystem::path& file_path);
     
     // Retrieve a file from objects directory
-    bool restore_file(const std::string& hash, const std::filesystem::path& target_path);
+    bool restore_file(const std::string& hash, const std::filesystem::path& target_path, bool link = false);
+    
+    bool write_worktrees(const std::vector<WorktreeRef>& worktrees);
     
     // Save commit object
     bool save_commit(const Commit& commit);
@@ -57,8 +191,15 @@ private:
     // Update HEAD reference
     bool update_head(const std::string& commit_hash);
     
-    // Generate simple hash (not cryptographic, just for demo)
-    std::string generate_hash(const std::string& content);
+    // Commits no other commit names as its parent, i.e. the newest commit
+    // of each line of history, so newer commits survive a checkout of an
+    // older one. Read from .vsdb_tips, or found by reading every commit
+    // object if that file is missing; nullopt if neither works.
+    std::optional<std::vector<std::string>> get_tips() const;
+    bool write_tips(const std::vector<std::string>& tips);
+    
+    // Whether an object file holds what its id says
+    bool verify_object(const std::string& id, const std::filesystem::path& file) const;
 };
 
 } // namespace vsdb
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "gitstore/merkle.h"
+#include "util/sha256.h"
+
+namespace vsdb {
+
+MerkleTree::MerkleTree(const std::vector<std::string>& leaves) {
+    std::vector<std::string> hashes;
+    hashes.reserve(leaves.size());
+    for (const auto& leaf : leaves) {
+        hashes.push_back(leaf_hash(leaf));
+    }
+    build(std::move(hashes));
+}
+
+MerkleTree MerkleTree::from_hashes(std::vector<std::string> hashes) {
+    MerkleTree tree;
+    tree.build(std::move(hashes));
+    return tree;
+}
+
+void MerkleTree::build(std::vector<std::string> hashes) {
+    leaf_count_ = hashes.size();
+    if (hashes.empty()) {
+        hashes.push_back(Sha256::hex(""));
+    }
+    
+    levels_.push_back(std::move(hashes));
+    while (levels_.back().size() > 1) {
+        const auto& below = levels_.back();
+        std::vector<std::string> level;
+        level.reserve((below.size() + 1) / 2);
+        for (size_t i = 0; i + 1 < below.size(); i += 2) {
+            level.push_back(node_hash(below[i], below[i + 1]));
+        }
+        if (below.size() % 2 == 1) {
+            level.push_back(below.back());
+        }
+        levels_.push_back(std::move(level));
+    }
+}
+
+std::vector<MerkleStep> MerkleTree::proof(size_t index) const {
+    std::vector<MerkleStep> steps;
+    if (index >= leaf_count_) {
+        return steps;
+    }
+    
+    for (size_t level = 0; level + 1 < levels_.size(); ++level) {
+        size_t sibling = index ^ 1;
+        if (sibling < levels_[level].size()) {
+            steps.push_back({levels_[level][sibling], sibling < index});
+        }
+        index /= 2;
+    }
+    return steps;
+}
+
+std::string MerkleTree::leaf_hash(std::string_view data) {
+    Sha256 sha;
+    sha.update("\x00", 1);
+    sha.update(data);
+    return Sha256::to_hex(sha.finish());
+}
+
+std::string MerkleTree::node_hash(const std::string& left, const std::string& right) {
+    Sha256 sha;
+    sha.update("\x01", 1);
+    sha.update(left);
+    sha.update(right);
+    return Sha256::to_hex(sha.finish());
+}
+
+std::string MerkleTree::root_from_proof(std::string hash, const std::vector<MerkleStep>& proof) {
+    for (const auto& step : proof) {
+        hash = step.sibling_left ? node_hash(step.sibling, hash) : node_hash(hash, step.sibling);
+    }
+    return hash;
+}
+
+} // namespace vsdb
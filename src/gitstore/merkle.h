@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vsdb {
+
+// One level of an inclusion proof: the sibling hash and its side
+struct MerkleStep {
+    std::string sibling;
+    bool sibling_left = false;
+};
+
+// Binary SHA-256 hash tree. Leaves and inner nodes are hashed with
+// different prefixes, so a leaf can never pass for a subtree. An odd node
+// at the end of a level moves up unchanged.
+class MerkleTree {
+public:
+    // Tree over the hashes of these leaf contents
+    explicit MerkleTree(const std::vector<std::string>& leaves);
+    
+    // Tree whose leaves are already hashes, e.g. roots of subtrees
+    static MerkleTree from_hashes(std::vector<std::string> hashes);
+    
+    // SHA-256 of the empty string for a tree without leaves
+    const std::string& root() const { return levels_.back().front(); }
+    size_t leaf_count() const { return leaf_count_; }
+    
+    // Siblings from leaf `index` up to the root
+    std::vector<MerkleStep> proof(size_t index) const;
+    
+    static std::string leaf_hash(std::string_view data);
+    static std::string node_hash(const std::string& left, const std::string& right);
+    
+    // Root reached by applying a proof to a leaf hash
+    static std::string root_from_proof(std::string hash, const std::vector<MerkleStep>& proof);
+    
+private:
+    MerkleTree() = default;
+    void build(std::vector<std::string> hashes);
+    
+    std::vector<std::vector<std::string>> levels_; // Leaf hashes first
+    size_t leaf_count_ = 0;
+};
+
+} // namespace vsdb
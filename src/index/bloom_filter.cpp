@@ -0,0 +1,94 @@
+#include "index/bloom_filter.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace vsdb {
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'S', 'D', 'B', 'B', 'L', 'M', '1'};
+
+} // namespace
+
+BloomFilter::BloomFilter(size_t capacity)
+    : capacity_(std::max(capacity, kMinKeys)) {
+    bits_.resize((capacity_ * kBitsPerKey + 63) / 64, 0);
+}
+
+// FNV-1a, stable across builds since the bits are persisted
+uint64_t BloomFilter::hash(const std::string& key) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void BloomFilter::add(const std::string& key) {
+    const uint64_t bit_count = bits_.size() * 64;
+    const uint64_t h1 = hash(key);
+    const uint64_t h2 = (h1 >> 33) | 1;
+    
+    for (size_t i = 0; i < kHashes; ++i) {
+        uint64_t bit = (h1 + i * h2) % bit_count;
+        bits_[bit / 64] |= (1ULL << (bit % 64));
+    }
+    keys_++;
+}
+
+bool BloomFilter::may_contain(const std::string& key) const {
+    const uint64_t bit_count = bits_.size() * 64;
+    const uint64_t h1 = hash(key);
+    const uint64_t h2 = (h1 >> 33) | 1;
+    
+    for (size_t i = 0; i < kHashes; ++i) {
+        uint64_t bit = (h1 + i * h2) % bit_count;
+        if (!(bits_[bit / 64] & (1ULL << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BloomFilter::save_to_file(const std::filesystem::path& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    
+    uint64_t header[3] = {capacity_, keys_, bits_.size()};
+    file.write(kMagic, sizeof(kMagic));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(bits_.data()), bits_.size() * sizeof(uint64_t));
+    
+    return file.good();
+}
+
+std::unique_ptr<BloomFilter> BloomFilter::load_from_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return nullptr;
+    
+    char magic[sizeof(kMagic)];
+    uint64_t header[3];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    
+    if (!file || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        return nullptr;
+    }
+    
+    auto filter = std::make_unique<BloomFilter>(header[0]);
+    if (filter->bits_.size() != header[2]) {
+        return nullptr;
+    }
+    
+    filter->keys_ = header[1];
+    file.read(reinterpret_cast<char*>(filter->bits_.data()), filter->bits_.size() * sizeof(uint64_t));
+    
+    if (!file) {
+        return nullptr;
+    }
+    return filter;
+}
+
+} // namespace vsdb
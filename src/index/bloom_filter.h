@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vsdb {
+
+// Probabilistic set of primary keys. A negative answer is exact, so
+// lookups of keys that were never inserted need no table access.
+// Persisted next to the table as <table>.bloom.
+class BloomFilter {
+public:
+    static constexpr size_t kBitsPerKey = 10; // ~1% false positives
+    static constexpr size_t kHashes = 7;
+    static constexpr size_t kMinKeys = 1024;
+    
+    explicit BloomFilter(size_t capacity = kMinKeys);
+    
+    void add(const std::string& key);
+    bool may_contain(const std::string& key) const;
+    
+    size_t key_count() const { return keys_; }
+    
+    // Sized for this many keys before the false positive rate degrades
+    size_t capacity() const { return capacity_; }
+    
+    bool save_to_file(const std::filesystem::path& path) const;
+    static std::unique_ptr<BloomFilter> load_from_file(const std::filesystem::path& path);
+    
+private:
+    std::vector<uint64_t> bits_;
+    size_t capacity_;
+    size_t keys_ = 0;
+    
+    static uint64_t hash(const std::string& key);
+};
+
+} // namespace vsdb
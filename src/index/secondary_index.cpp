@@ -0,0 +1,178 @@
+#include "index/secondary_index.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace vsdb {
+
+namespace {
+
+// Shared string prefixes keep TEXT nodes small, so they are wider
+constexpr int kTreeOrder = 16;
+constexpr int kTextTreeOrder = 64;
+
+TypedValue as_typed(const TypedValue& key) {
+    return key;
+}
+
+TypedValue as_typed(const std::string& key) {
+    TypedValue value;
+    value.type = DataType::TEXT;
+    value.text_value = key;
+    return value;
+}
+
+} // namespace
+
+SecondaryIndex::SecondaryIndex(const std::string& column, DataType type)
+    : column_(column), type_(type), tree_(kTreeOrder), text_tree_(kTextTreeOrder) {
+}
+
+template<typename Tree, typename Key>
+void SecondaryIndex::insert_row(Tree& tree, const Key& key, size_t row_id) {
+    if (auto* rows = tree.find(key)) {
+        // Appends arrive in row id order; only re-inserted rows need the search
+        if (rows->empty() || rows->back() < row_id ||
+            std::find(rows->begin(), rows->end(), row_id) == rows->end()) {
+            rows->push_back(row_id);
+        }
+    } else {
+        tree.insert(key, {row_id});
+    }
+}
+
+void SecondaryIndex::insert(const std::string& raw_value, size_t row_id) {
+    if (type_ == DataType::TEXT) {
+        insert_row(text_tree_, raw_value, row_id);
+    } else {
+        insert_row(tree_, TypedValue::parse(type_, raw_value), row_id);
+    }
+}
+
+template<typename Tree, typename Key>
+std::optional<SecondaryIndex::Rows> SecondaryIndex::lookup_rows(const Tree& tree, CompareOp op, const Key& key,
+                                                                const TypedValue& value) const {
+    Rows result;
+    
+    if (op == CompareOp::EQ) {
+        if (auto rows = tree.search(key)) {
+            result = *rows;
+        }
+        if (!std::is_sorted(result.begin(), result.end())) {
+            std::sort(result.begin(), result.end());
+        }
+        return result;
+    }
+    
+    std::optional<Key> low, high;
+    switch (op) {
+        case CompareOp::LT:
+        case CompareOp::LE:
+            high = key;
+            break;
+        case CompareOp::GT:
+        case CompareOp::GE:
+            low = key;
+            break;
+        default:
+            return std::nullopt;
+    }
+    
+    tree.scan_range(low, high, [&](const Key& k, const Rows& rows) {
+        if (Predicate::evaluate(op, as_typed(k), value)) {
+            result.insert(result.end(), rows.begin(), rows.end());
+        }
+    });
+    
+    // Ascending row ids, each once; an updated row can be listed under
+    // both its old and new value
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::optional<std::vector<size_t>> SecondaryIndex::lookup(CompareOp op, const TypedValue& value) const {
+    if (type_ == DataType::TEXT) {
+        return lookup_rows(text_tree_, op, value.text_value, value);
+    }
+    return lookup_rows(tree_, op, value, value);
+}
+
+void SecondaryIndex::traverse(const std::function<void(const std::string&, const Rows&)>& callback) const {
+    if (type_ == DataType::TEXT) {
+        text_tree_.traverse(callback);
+    } else {
+        tree_.traverse([&](const TypedValue& key, const Rows& rows) {
+            callback(key.to_string(), rows);
+        });
+    }
+}
+
+void SecondaryIndex::insert_rows(const std::string& raw_value, Rows rows) {
+    if (type_ == DataType::TEXT) {
+        text_tree_.insert(raw_value, std::move(rows));
+    } else {
+        tree_.insert(TypedValue::parse(type_, raw_value), std::move(rows));
+    }
+}
+
+bool SecondaryIndex::save_to_file(const std::filesystem::path& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+    
+    std::vector<std::pair<std::string, const std::vector<size_t>*>> entries;
+    traverse([&](const std::string& key, const std::vector<size_t>& rows) {
+        entries.emplace_back(key, &rows);
+    });
+    
+    file << column_ << "\n";
+    file << static_cast<int>(type_) << "\n";
+    file << entries.size() << "\n";
+    
+    for (const auto& [key, rows] : entries) {
+        file << key << "\t";
+        for (size_t i = 0; i < rows->size(); ++i) {
+            if (i > 0) file << " ";
+            file << (*rows)[i];
+        }
+        file << "\n";
+    }
+    
+    return true;
+}
+
+std::unique_ptr<SecondaryIndex> SecondaryIndex::load_from_file(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return nullptr;
+    
+    std::string column;
+    int type;
+    size_t num_keys;
+    
+    std::getline(file, column);
+    file >> type >> num_keys;
+    file.ignore();
+    
+    auto index = std::make_unique<SecondaryIndex>(column, static_cast<DataType>(type));
+    
+    for (size_t i = 0; i < num_keys; ++i) {
+        std::string line;
+        std::getline(file, line);
+        
+        size_t tab = line.rfind('\t');
+        if (tab == std::string::npos) continue;
+        
+        std::vector<size_t> rows;
+        std::istringstream ss(line.substr(tab + 1));
+        size_t row_id;
+        while (ss >> row_id) {
+            rows.push_back(row_id);
+        }
+        
+        index->insert_rows(line.substr(0, tab), std::move(rows));
+    }
+    
+    return index;
+}
+
+} // namespace vsdb
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "btree/btree.h"
+#include "db/predicate.h"
+#include "db/value.h"
+
+namespace vsdb {
+
+// Maps typed column values to the ids (insertion positions) of the rows
+// holding them. Persisted next to the table as <table>.<column>.idx.
+// TEXT values are kept as plain strings in prefix-compressed nodes.
+class SecondaryIndex {
+public:
+    SecondaryIndex(const std::string& column, DataType type);
+    
+    const std::string& get_column() const { return column_; }
+    DataType get_type() const { return type_; }
+    
+    // Adding a row id already listed under the value is a no-op. An
+    // updated row is inserted under its new value while the old entry
+    // stays; callers re-check candidate rows.
+    void insert(const std::string& raw_value, size_t row_id);
+    
+    // Distinct row ids matching "column <op> value" in ascending order.
+    // Returns nullopt for operators the index cannot answer (NE).
+    std::optional<std::vector<size_t>> lookup(CompareOp op, const TypedValue& value) const;
+    
+    bool save_to_file(const std::filesystem::path& path) const;
+    static std::unique_ptr<SecondaryIndex> load_from_file(const std::filesystem::path& path);
+    
+private:
+    using Rows = std::vector<size_t>;
+    
+    std::string column_;
+    DataType type_;
+    BTree<TypedValue, Rows> tree_;       // INT, FLOAT and BOOL columns
+    BTree<std::string, Rows> text_tree_; // TEXT columns
+    
+    template<typename Tree, typename Key>
+    static void insert_row(Tree& tree, const Key& key, size_t row_id);
+    
+    template<typename Tree, typename Key>
+    std::optional<Rows> lookup_rows(const Tree& tree, CompareOp op, const Key& key,
+                                    const TypedValue& value) const;
+    
+    // Visit every key as its stored string, in order
+    void traverse(const std::function<void(const std::string&, const Rows&)>& callback) const;
+    void insert_rows(const std::string& raw_value, Rows rows);
+};
+
+} // namespace vsdb
@@ -0,0 +1,149 @@
+#include "index/zone_map.h"
+#include <algorithm>
+#include <fstream>
+
+namespace vsdb {
+
+ZoneMap::ZoneMap(std::vector<DataType> types)
+    : types_(std::move(types)) {
+}
+
+void ZoneMap::add(const std::vector<std::string>& values) {
+    bool new_block = (rows_ % kBlockRows == 0);
+    if (new_block) {
+        blocks_.emplace_back(types_.size());
+    }
+    
+    auto& block = blocks_.back();
+    for (size_t col = 0; col < types_.size() && col < values.size(); ++col) {
+        TypedValue value = TypedValue::parse(types_[col], values[col]);
+        ZoneStats& stats = block[col];
+        
+        if (new_block) {
+            stats.min = value;
+            stats.max = value;
+        } else {
+            if (value < stats.min) stats.min = value;
+            if (value > stats.max) stats.max = std::move(value);
+        }
+        
+        if (values[col].empty()) {
+            stats.null_count++;
+        }
+    }
+    
+    rows_++;
+}
+
+void ZoneMap::widen(size_t row_id, const std::vector<std::string>& values) {
+    size_t block = row_id / kBlockRows;
+    if (block >= blocks_.size()) return;
+    
+    for (size_t col = 0; col < types_.size() && col < values.size(); ++col) {
+        TypedValue value = TypedValue::parse(types_[col], values[col]);
+        ZoneStats& stats = blocks_[block][col];
+        
+        if (value < stats.min) stats.min = value;
+        if (value > stats.max) stats.max = std::move(value);
+        if (values[col].empty()) {
+            stats.null_count++;
+        }
+    }
+}
+
+void ZoneMap::add_column(DataType type, const std::string& value) {
+    ZoneStats stats;
+    stats.min = TypedValue::parse(type, value);
+    stats.max = stats.min;
+    
+    types_.push_back(type);
+    for (size_t block = 0; block < blocks_.size(); ++block) {
+        size_t rows = std::min(kBlockRows, rows_ - block * kBlockRows);
+        stats.null_count = value.empty() ? rows : 0;
+        blocks_[block].push_back(stats);
+    }
+}
+
+void ZoneMap::drop_column(size_t column) {
+    if (column >= types_.size()) return;
+    
+    types_.erase(types_.begin() + column);
+    for (auto& block : blocks_) {
+        block.erase(block.begin() + column);
+    }
+}
+
+bool ZoneMap::may_match(size_t block, const BoundPredicate& predicate) const {
+    if (block >= blocks_.size() || predicate.column >= types_.size()) {
+        return true;
+    }
+    
+    const ZoneStats& stats = blocks_[block][predicate.column];
+    const TypedValue& v = predicate.operand;
+    
+    switch (predicate.op) {
+        case CompareOp::EQ: return !(v < stats.min) && !(v > stats.max);
+        case CompareOp::NE: return !(stats.min == v && stats.max == v);
+        case CompareOp::LT: return stats.min < v;
+        case CompareOp::LE: return !(stats.min > v);
+        case CompareOp::GT: return stats.max > v;
+        case CompareOp::GE: return !(stats.max < v);
+    }
+    return true;
+}
+
+bool ZoneMap::save_to_file(const std::filesystem::path& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+    
+    file << kBlockRows << " " << rows_ << " " << types_.size() << "\n";
+    
+    // Three lines per block and column: null count, min, max
+    for (const auto& block : blocks_) {
+        for (const auto& stats : block) {
+            file << stats.null_count << "\n"
+                 << stats.min.to_string() << "\n"
+                 << stats.max.to_string() << "\n";
+        }
+    }
+    
+    return true;
+}
+
+std::optional<ZoneMap> ZoneMap::load_from_file(const std::filesystem::path& path,
+                                               const std::vector<DataType>& types) {
+    std::ifstream file(path);
+    if (!file.is_open()) return std::nullopt;
+    
+    size_t block_rows = 0, rows = 0, columns = 0;
+    file >> block_rows >> rows >> columns;
+    file.ignore();
+    
+    if (!file || block_rows != kBlockRows || columns != types.size()) {
+        return std::nullopt;
+    }
+    
+    ZoneMap zones(types);
+    zones.rows_ = rows;
+    zones.blocks_.resize((rows + kBlockRows - 1) / kBlockRows, std::vector<ZoneStats>(columns));
+    
+    for (auto& block : zones.blocks_) {
+        for (size_t col = 0; col < columns; ++col) {
+            std::string nulls, min, max;
+            std::getline(file, nulls);
+            std::getline(file, min);
+            std::getline(file, max);
+            
+            block[col].null_count = std::strtoull(nulls.c_str(), nullptr, 10);
+            block[col].min = TypedValue::parse(types[col], min);
+            block[col].max = TypedValue::parse(types[col], max);
+        }
+    }
+    
+    if (!file) {
+        return std::nullopt;
+    }
+    return zones;
+}
+
+} // namespace vsdb
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include "db/predicate.h"
+#include "db/value.h"
+
+namespace vsdb {
+
+// Statistics of one column within one block of rows
+struct ZoneStats {
+    TypedValue min;
+    TypedValue max;
+    size_t null_count = 0; // Empty values
+};
+
+// Min/max statistics per fixed-size block of rows for every column,
+// letting filtered scans skip blocks whose range cannot match.
+// Maintained as rows are appended and persisted as <table>.zones.
+class ZoneMap {
+public:
+    static constexpr size_t kBlockRows = 1024;
+    
+    explicit ZoneMap(std::vector<DataType> types = {});
+    
+    void add(const std::vector<std::string>& values);
+    
+    // Extend the block holding an existing row to cover new values
+    void widen(size_t row_id, const std::vector<std::string>& values);
+    
+    // Schema changes: a new column holds `value` in every existing row
+    void add_column(DataType type, const std::string& value);
+    void drop_column(size_t column);
+    
+    const std::vector<DataType>& types() const { return types_; }
+    size_t row_count() const { return rows_; }
+    size_t block_count() const { return blocks_.size(); }
+    
+    // False only if no row of the block can satisfy the predicate
+    bool may_match(size_t block, const BoundPredicate& predicate) const;
+    
+    bool save_to_file(const std::filesystem::path& path) const;
+    static std::optional<ZoneMap> load_from_file(const std::filesystem::path& path,
+                                                 const std::vector<DataType>& types);
+    
+private:
+    std::vector<DataType> types_;
+    std::vector<std::vector<ZoneStats>> blocks_; // [block][column]
+    size_t rows_ = 0;
+};
+
+} // namespace vsdb
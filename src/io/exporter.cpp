@@ -0,0 +1,278 @@
+#include "io/exporter.h"
+#include "io/output_writer.h"
+#include "util/byte_codec.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <deque>
+#include <future>
+
+namespace vsdb {
+
+namespace {
+
+constexpr char kBinaryMagic[8] = {'V', 'S', 'D', 'B', 'E', 'X', 'P', '1'};
+
+void append_csv_field(std::string& out, const std::string& value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        out += value;
+        return;
+    }
+    
+    out.push_back('"');
+    for (char c : value) {
+        if (c == '"') out.push_back('"');
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+void append_csv_row(std::string& out, const std::vector<std::string>& values) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) out.push_back(',');
+        append_csv_field(out, values[i]);
+    }
+    out.push_back('\n');
+}
+
+void append_json_string(std::string& out, const std::string& value) {
+    static const char kHex[] = "0123456789abcdef";
+    
+    out.push_back('"');
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out.push_back(kHex[(c >> 4) & 0xf]);
+                    out.push_back(kHex[c & 0xf]);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+// Values that do not parse as their column's type are kept as strings
+void append_json_value(std::string& out, DataType type, const std::string& value) {
+    if (value.empty()) {
+        out += "null";
+        return;
+    }
+    
+    const char* first = value.data();
+    const char* last = value.data() + value.size();
+    char buffer[32];
+    
+    switch (type) {
+        case DataType::INT: {
+            long long v = 0;
+            auto [end, ec] = std::from_chars(first, last, v);
+            if (ec == std::errc() && end == last) {
+                auto printed = std::to_chars(buffer, buffer + sizeof(buffer), v);
+                out.append(buffer, printed.ptr);
+                return;
+            }
+            break;
+        }
+        case DataType::FLOAT: {
+            double v = 0;
+            auto [end, ec] = std::from_chars(first, last, v);
+            if (ec == std::errc() && end == last && std::isfinite(v)) {
+                auto printed = std::to_chars(buffer, buffer + sizeof(buffer), v);
+                out.append(buffer, printed.ptr);
+                return;
+            }
+            break;
+        }
+        case DataType::BOOL:
+            out += TypedValue::parse(type, value).int_value ? "true" : "false";
+            return;
+        case DataType::TEXT:
+            break;
+    }
+    append_json_string(out, value);
+}
+
+class RowFormatter {
+public:
+    RowFormatter(ExportFormat format, const TableSchema& schema)
+        : format_(format), schema_(schema) {
+        for (const auto& col : schema_.columns) {
+            std::string key;
+            append_json_string(key, col.name);
+            keys_.push_back(key + ":");
+        }
+    }
+    
+    void header(std::string& out) const {
+        if (format_ == ExportFormat::CSV) {
+            std::vector<std::string> names;
+            for (const auto& col : schema_.columns) {
+                names.push_back(col.name);
+            }
+            append_csv_row(out, names);
+        } else if (format_ == ExportFormat::BINARY) {
+            ByteEncoder encoder;
+            encoder.u32(static_cast<uint32_t>(schema_.columns.size()));
+            for (const auto& col : schema_.columns) {
+                encoder.str(col.name);
+                encoder.u8(static_cast<uint8_t>(col.type));
+            }
+            out.append(kBinaryMagic, sizeof(kBinaryMagic));
+            out += encoder.bytes();
+        }
+    }
+    
+    void row(std::string& out, const std::vector<std::string>& values) const {
+        switch (format_) {
+            case ExportFormat::CSV:
+                append_csv_row(out, values);
+                break;
+            case ExportFormat::JSONL:
+                out.push_back('{');
+                for (size_t i = 0; i < values.size(); ++i) {
+                    if (i > 0) out.push_back(',');
+                    out += keys_[i];
+                    append_json_value(out, schema_.columns[i].type, values[i]);
+                }
+                out += "}\n";
+                break;
+            case ExportFormat::BINARY:
+                out.push_back(1);
+                for (const auto& value : values) {
+                    uint32_t size = static_cast<uint32_t>(value.size());
+                    out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+                    out += value;
+                }
+                break;
+        }
+    }
+    
+    void footer(std::string& out, uint64_t rows) const {
+        if (format_ == ExportFormat::BINARY) {
+            out.push_back(0);
+            out.append(reinterpret_cast<const char*>(&rows), sizeof(rows));
+        }
+    }
+    
+private:
+    ExportFormat format_;
+    const TableSchema& schema_;
+    std::vector<std::string> keys_; // JSON object keys, quoted, with the colon
+};
+
+struct Segment {
+    Status status;
+    std::string text;
+    size_t rows = 0;
+};
+
+Segment format_segment(const Table& table, const RowFormatter& formatter, size_t begin, size_t end) {
+    Segment segment;
+    
+    ScanOptions options;
+    options.row_begin = begin;
+    options.row_end = end;
+    std::unique_ptr<TableCursor> cursor;
+    if (segment.status = table.open_cursor(options, &cursor); !segment.status) {
+        return segment;
+    }
+    
+    std::vector<Record> batch;
+    while (cursor->next_batch(batch)) {
+        for (const auto& record : batch) {
+            formatter.row(segment.text, record.values);
+        }
+        segment.rows += batch.size();
+    }
+    segment.status = cursor->status();
+    return segment;
+}
+
+} // namespace
+
+std::optional<ExportFormat> parse_export_format(const std::string& name) {
+    if (name == "csv") return ExportFormat::CSV;
+    if (name == "jsonl") return ExportFormat::JSONL;
+    if (name == "binary") return ExportFormat::BINARY;
+    return std::nullopt;
+}
+
+Status export_table(const Table& table, const ExportOptions& options, std::ostream& out,
+                    size_t* exported) {
+    RowFormatter formatter(options.format, table.get_schema());
+    OutputWriter writer(out);
+    
+    std::string text;
+    formatter.header(text);
+    writer.write(text);
+    
+    const size_t rows = table.row_count();
+    const size_t segment_rows = std::max<size_t>(options.segment_rows, 1);
+    const size_t segments = (rows + segment_rows - 1) / segment_rows;
+    const size_t threads = std::min(std::max<size_t>(options.threads, 1), segments);
+    size_t total = 0;
+    
+    auto run = [&, segment_rows](size_t index) {
+        size_t begin = index * segment_rows;
+        return format_segment(table, formatter, begin, std::min(rows, begin + segment_rows));
+    };
+    
+    auto emit = [&](Segment segment) {
+        if (!segment.status) {
+            return segment.status;
+        }
+        writer.write(segment.text);
+        total += segment.rows;
+        return Status::ok();
+    };
+    
+    if (threads <= 1) {
+        for (size_t i = 0; i < segments; ++i) {
+            if (Status status = emit(run(i)); !status) {
+                return status;
+            }
+        }
+    } else {
+        // A window of segments in flight; the oldest is written as soon as
+        // it is formatted, keeping the output in row order
+        ThreadPool pool(threads);
+        std::deque<std::future<Segment>> pending;
+        size_t next = 0;
+        
+        while (next < segments || !pending.empty()) {
+            while (next < segments && pending.size() < threads * 2) {
+                pending.push_back(pool.submit([&run, i = next]() { return run(i); }));
+                next++;
+            }
+            
+            Segment segment = pending.front().get();
+            pending.pop_front();
+            if (Status status = emit(std::move(segment)); !status) {
+                for (auto& task : pending) {
+                    task.wait();
+                }
+                return status;
+            }
+        }
+    }
+    
+    text.clear();
+    formatter.footer(text, total);
+    writer.write(text);
+    writer.flush();
+    
+    if (exported) {
+        *exported = total;
+    }
+    return out ? Status::ok() : Status::error("Failed to write the export");
+}
+
+} // namespace vsdb
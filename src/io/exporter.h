@@ -0,0 +1,38 @@
+#pragma once
+
+#include <optional>
+#include <ostream>
+#include <string>
+#include "db/database.h"
+#include "index/zone_map.h"
+#include "util/status.h"
+#include "util/thread_pool.h"
+
+namespace vsdb {
+
+enum class ExportFormat {
+    CSV,    // Header row, then one line per row; fields quoted per RFC 4180
+    JSONL,  // One JSON object per row; numbers and booleans typed by column, empty values null
+    BINARY  // See below
+};
+
+// Binary exports: "VSDBEXP1", u32 column count, then per column its name
+// (u32 length + bytes) and u8 type. Each row is a u8 1 followed by its
+// values as length-prefixed strings; a u8 0 and the u64 row count end
+// the stream. Integers are little-endian.
+
+std::optional<ExportFormat> parse_export_format(const std::string& name);
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::CSV;
+    size_t threads = ThreadPool::default_threads();
+    size_t segment_rows = 64 * ZoneMap::kBlockRows; // Row ids formatted per task
+};
+
+// Stream the current rows of a table to `out`. Segments of row ids are
+// formatted in parallel and written in order; only a few segments per
+// thread are buffered at once. The table must not change meanwhile.
+Status export_table(const Table& table, const ExportOptions& options, std::ostream& out,
+                    size_t* exported = nullptr);
+
+} // namespace vsdb
@@ -0,0 +1,43 @@
+#include "io/output_writer.h"
+
+namespace vsdb {
+
+OutputWriter::OutputWriter(std::ostream& out, size_t capacity)
+    : out_(out), capacity_(capacity) {
+    buffer_.reserve(capacity_ + 1024);
+}
+
+OutputWriter::~OutputWriter() {
+    flush();
+}
+
+void OutputWriter::write_row(const std::vector<std::string>& values, char delimiter) {
+    for (const auto& value : values) {
+        buffer_.append(value);
+        buffer_.push_back(delimiter);
+    }
+    buffer_.push_back('\n');
+    
+    if (buffer_.size() >= capacity_) {
+        flush();
+    }
+}
+
+void OutputWriter::flush() {
+    if (buffer_.empty()) return;
+    
+    if (copy_) {
+        if (copy_->size() + buffer_.size() > copy_limit_) {
+            copy_->clear();
+            copy_ = nullptr;
+        } else {
+            copy_->append(buffer_);
+        }
+    }
+    
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    out_.flush();
+    buffer_.clear();
+}
+
+} // namespace vsdb
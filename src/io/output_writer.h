@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vsdb {
+
+// Collects formatted output in a large buffer and hands it to the
+// underlying stream in one write per flush instead of one per value.
+class OutputWriter {
+public:
+    static constexpr size_t kDefaultCapacity = 64 * 1024;
+    
+    explicit OutputWriter(std::ostream& out, size_t capacity = kDefaultCapacity);
+    ~OutputWriter();
+    
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+    
+    void write(std::string_view text) {
+        buffer_.append(text);
+        if (buffer_.size() >= capacity_) flush();
+    }
+    
+    void put(char c) {
+        buffer_.push_back(c);
+        if (buffer_.size() >= capacity_) flush();
+    }
+    
+    // Each value followed by the delimiter, then a newline
+    void write_row(const std::vector<std::string>& values, char delimiter = '\t');
+    
+    void flush();
+    
+    // Also append everything written to `copy`. Once the copy would grow
+    // past `max_bytes` it is cleared and copying stops.
+    void capture(std::string* copy, size_t max_bytes) {
+        copy_ = copy;
+        copy_limit_ = max_bytes;
+    }
+    
+private:
+    std::ostream& out_;
+    std::string buffer_;
+    size_t capacity_;
+    std::string* copy_ = nullptr;
+    size_t copy_limit_ = 0;
+};
+
+} // namespace vsdb
@@ -1,5 +1,17 @@
 #include "cli/cli_parser.h"
 #include "db/database.h"
+#include "io/exporter.h"
+#include "io/output_writer.h"
+#include "query/aggregate.h"
+#include "query/hash_join.h"
+#include "query/result_cache.h"
+#include "query/sort.h"
+#include "util/metrics.h"
+#include "util/trace.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
@@ -8,13 +20,15 @@ std::vector<vsdb::Column> parse_columns(const std::vector<std::string>& col_defs
     
     for (const auto& def : col_defs) {
         std::stringstream ss(def);
-        std::string name, type_str;
+        std::string name, type_str, flag;
         
         std::getline(ss, name, ':');
-        std::getline(ss, type_str);
+        std::getline(ss, type_str, ':');
+        std::getline(ss, flag);
         
         vsdb::Column col;
         col.name = name;
+        col.primary_key = (flag == "pk");
         
         if (type_str == "int") {
             col.type = vsdb::DataType::INT;
@@ -35,41 +49,502 @@ std::vector<vsdb::Column> parse_columns(const std::vector<std::string>& col_defs
     return columns;
 }
 
-void print_table(const vsdb::TableSchema& schema, const std::vector<vsdb::Record>& records) {
-    // Print header
-    for (const auto& col : schema.columns) {
-        std::cout << col.name << "\t";
-    }
-    std::cout << "\n";
+void print_header(vsdb::OutputWriter& out, const std::vector<std::string>& headers) {
+    out.write_row(headers);
     
     // Print separator
-    for (size_t i = 0; i < schema.columns.size(); ++i) {
-        std::cout << "--------\t";
+    for (size_t i = 0; i < headers.size(); ++i) {
+        out.write("--------\t");
+    }
+    out.put('\n');
+}
+
+void print_footer(vsdb::OutputWriter& out, size_t rows) {
+    out.put('\n');
+    out.write(std::to_string(rows));
+    out.write(" rows returned\n");
+}
+
+// Prints a failed status; returns the process exit code
+int report_error(const vsdb::Status& status) {
+    if (status) {
+        return 0;
+    }
+    std::cerr << "Error: " << status.message() << "\n";
+    return 1;
+}
+
+// Parses --where expressions; prints the first invalid one
+bool parse_filters(const std::vector<std::string>& filters, std::vector<vsdb::Predicate>& predicates) {
+    for (const auto& filter : filters) {
+        auto pred = vsdb::Predicate::parse(filter);
+        if (!pred) {
+            std::cerr << "Error: Invalid filter '" << filter << "'\n";
+            return false;
+        }
+        predicates.push_back(*pred);
+    }
+    return true;
+}
+
+// With `capture`, the output is also collected there unless it grows
+// past `capture_limit`, in which case it is left empty
+int run_select(vsdb::Database& db, const vsdb::ParsedCommand& cmd,
+               std::string* capture = nullptr, size_t capture_limit = 0) {
+    auto table = db.get_table(cmd.table_name);
+    if (!table) {
+        std::cerr << "Error: Table '" << cmd.table_name << "' not found\n";
+        return 1;
+    }
+    
+    std::vector<vsdb::Predicate> predicates;
+    if (!parse_filters(cmd.filters, predicates)) {
+        return 1;
+    }
+    
+    if (!cmd.group_by.empty() && cmd.aggregates.empty()) {
+        std::cerr << "Error: --group-by requires at least one --agg\n";
+        return 1;
+    }
+    
+    if (!cmd.order_by.empty() && !cmd.aggregates.empty()) {
+        std::cerr << "Error: --order-by cannot be combined with --agg; groups are returned in key order\n";
+        return 1;
+    }
+    
+    std::vector<vsdb::AggregateSpec> aggregates;
+    for (const auto& expr : cmd.aggregates) {
+        auto spec = vsdb::AggregateSpec::parse(expr);
+        if (!spec) {
+            std::cerr << "Error: Invalid aggregate '" << expr << "'\n";
+            return 1;
+        }
+        aggregates.push_back(*spec);
+    }
+    
+    // Joins stream both inputs through a HashJoin; plain scans stream
+    // from a cursor, which also applies offset/limit so the scan can stop
+    // early
+    const vsdb::TableSchema* schema = &table->get_schema();
+    std::optional<vsdb::HashJoin> join;
+    std::unique_ptr<vsdb::TableCursor> cursor, left_cursor, right_cursor;
+    std::unique_ptr<vsdb::JoinCursor> joined;
+    vsdb::BatchSource source;
+    bool cursor_applies_limit = false;
+    
+    if (!cmd.join_table.empty()) {
+        auto other = db.get_table(cmd.join_table);
+        if (!other) {
+            std::cerr << "Error: Table '" << cmd.join_table << "' not found\n";
+            return 1;
+        }
+        
+        auto spec = vsdb::JoinSpec::parse(cmd.join_on, cmd.table_name, cmd.join_table);
+        if (!spec) {
+            std::cerr << "Error: --join requires --on <" << cmd.table_name << ".col="
+                      << cmd.join_table << ".col>\n";
+            return 1;
+        }
+        
+        join.emplace(table->get_schema(), other->get_schema(), *spec);
+        if (vsdb::Status status = join->validate(); !status) {
+            return report_error(status);
+        }
+        
+        vsdb::ScanOptions options;
+        options.predicates = predicates;
+        if (vsdb::Status status = db.open_cursor(cmd.table_name, options, &left_cursor); !status) {
+            return report_error(status);
+        }
+        if (vsdb::Status status = db.open_cursor(cmd.join_table, vsdb::ScanOptions(), &right_cursor); !status) {
+            return report_error(status);
+        }
+        
+        vsdb::BatchSource left = [&left_cursor](std::vector<vsdb::Record>& batch) {
+            return left_cursor->next_batch(batch);
+        };
+        vsdb::BatchSource right = [&right_cursor](std::vector<vsdb::Record>& batch) {
+            return right_cursor->next_batch(batch);
+        };
+        if (vsdb::Status status = join->run(left, right, cmd.memory_mb * 1024 * 1024, db.get_temp_dir(), &joined);
+            !status) {
+            return report_error(status);
+        }
+        schema = &join->schema();
+        source = [&joined](std::vector<vsdb::Record>& batch) { return joined->next_batch(batch); };
+    } else {
+        vsdb::ScanOptions options;
+        options.predicates = predicates;
+        if (aggregates.empty() && cmd.order_by.empty()) {
+            options.offset = cmd.offset;
+            options.limit = cmd.limit;
+            cursor_applies_limit = true;
+        }
+        
+        if (vsdb::Status status = db.open_cursor(cmd.table_name, options, &cursor); !status) {
+            return report_error(status);
+        }
+        source = [&cursor](std::vector<vsdb::Record>& batch) { return cursor->next_batch(batch); };
     }
-    std::cout << "\n";
     
-    // Print rows
-    for (const auto& record : records) {
-        for (const auto& value : record.values) {
-            std::cout << value << "\t";
+    // Error that ended reading the rows early, if any
+    auto source_status = [&]() -> vsdb::Status {
+        for (const auto* scan : {cursor.get(), left_cursor.get(), right_cursor.get()}) {
+            if (scan && !scan->status()) {
+                return scan->status();
+            }
         }
-        std::cout << "\n";
+        return joined ? joined->status() : vsdb::Status::ok();
+    };
+    
+    vsdb::OutputWriter out(std::cout);
+    if (capture) {
+        out.capture(capture, capture_limit);
     }
+    
+    // Applies offset/limit to operators that produce whole results
+    size_t skipped = 0;
+    size_t returned = 0;
+    auto emit = [&](const vsdb::Record& record) {
+        if (!cursor_applies_limit) {
+            if (skipped < cmd.offset) {
+                skipped++;
+                return;
+            }
+            if (cmd.limit && returned >= *cmd.limit) {
+                return;
+            }
+        }
+        out.write_row(record.values);
+        returned++;
+    };
+    
+    if (!aggregates.empty()) {
+        vsdb::Aggregator aggregator(*schema, aggregates, cmd.group_by);
+        if (vsdb::Status status = aggregator.validate(); !status) {
+            return report_error(status);
+        }
+        
+        auto result = cursor ? aggregator.run(*cursor) : aggregator.run(source);
+        if (vsdb::Status status = source_status(); !status) {
+            return report_error(status);
+        }
+        print_header(out, result.columns);
+        for (const auto& record : result.rows) {
+            emit(record);
+        }
+        print_footer(out, returned);
+        return 0;
+    }
+    
+    std::vector<std::string> headers;
+    for (const auto& col : schema->columns) {
+        headers.push_back(col.name);
+    }
+    
+    if (!cmd.order_by.empty()) {
+        vsdb::SortSpec spec{cmd.order_by, cmd.descending, std::nullopt};
+        if (cmd.limit) {
+            spec.limit = cmd.offset + *cmd.limit;
+        }
+        
+        vsdb::Sorter sorter(*schema, spec);
+        if (vsdb::Status status = sorter.validate(); !status) {
+            return report_error(status);
+        }
+        
+        std::vector<vsdb::Record> batch;
+        size_t pos = 0;
+        auto rows = [&](vsdb::Record& record) {
+            if (pos >= batch.size()) {
+                pos = 0;
+                if (!source(batch)) return false;
+            }
+            record = std::move(batch[pos++]);
+            return true;
+        };
+        
+        print_header(out, headers);
+        vsdb::Status status = sorter.run(rows, emit, cmd.memory_mb * 1024 * 1024, db.get_temp_dir());
+        if (status) {
+            status = source_status();
+        }
+        print_footer(out, returned);
+        out.flush();
+        return report_error(status);
+    }
+    
+    print_header(out, headers);
+    std::vector<vsdb::Record> batch;
+    while (source(batch)) {
+        for (const auto& record : batch) {
+            emit(record);
+        }
+        if (!cursor_applies_limit && cmd.limit && returned >= *cmd.limit) {
+            break;
+        }
+    }
+    if (vsdb::Status status = source_status(); !status) {
+        out.flush();
+        return report_error(status);
+    }
+    print_footer(out, returned);
+    return 0;
 }
 
-int main(int argc, char** argv) {
+// Cache key of a select over committed tables: their files' object
+// hashes plus the query, with filters in a canonical order so that
+// equivalent spellings share an entry
+std::string query_key(const vsdb::ParsedCommand& cmd, const std::vector<std::string>& objects) {
+    std::vector<std::string> filters;
+    for (const auto& filter : cmd.filters) {
+        auto pred = vsdb::Predicate::parse(filter);
+        filters.push_back(pred ? pred->column + '\x1f' + std::to_string(static_cast<int>(pred->op)) +
+                                 '\x1f' + pred->value
+                               : filter);
+    }
+    std::sort(filters.begin(), filters.end());
+    
+    std::ostringstream key;
+    key << "select\n";
+    for (const auto& object : objects) {
+        key << "object=" << object << "\n";
+    }
+    key << "table=" << cmd.table_name << "\n";
+    for (const auto& filter : filters) {
+        key << "where=" << filter << "\n";
+    }
+    for (const auto& agg : cmd.aggregates) {
+        key << "agg=" << agg << "\n";
+    }
+    for (const auto& col : cmd.group_by) {
+        key << "group=" << col << "\n";
+    }
+    key << "join=" << cmd.join_table << "\n"
+        << "on=" << cmd.join_on << "\n"
+        << "order=" << cmd.order_by << (cmd.descending ? " desc" : "") << "\n"
+        << "limit=" << (cmd.limit ? std::to_string(*cmd.limit) : "") << "\n"
+        << "offset=" << cmd.offset << "\n";
+    return key.str();
+}
+
+// Runs a select against the tables of a commit. Committed tables never
+// change, so the output is cached under their object hashes.
+int run_select_at(vsdb::Database& db, const vsdb::ParsedCommand& cmd) {
+    std::string commit;
+    if (vsdb::Status status = db.resolve_commit(cmd.at_commit, &commit); !status) {
+        return report_error(status);
+    }
+    
+    std::vector<std::string> tables{cmd.table_name};
+    if (!cmd.join_table.empty()) {
+        tables.push_back(cmd.join_table);
+    }
+    
+    std::vector<std::string> objects;
+    if (vsdb::Status status = db.table_objects(commit, tables, &objects); !status) {
+        return report_error(status);
+    }
+    
+    std::string key = query_key(cmd, objects);
+    vsdb::ResultCache cache(db.get_cache_dir());
+    if (auto cached = cache.get(key)) {
+        std::cout << *cached << std::flush;
+        return 0;
+    }
+    
+    // Miss: query a copy of the committed tables
+    auto root = db.get_temp_dir() /
+        ("at-" + commit + "-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    
+    int result = 1;
+    std::string output;
+    if (vsdb::Status status = db.materialize(commit, tables, root); !status) {
+        result = report_error(status);
+    } else {
+        vsdb::Database view(root);
+        result = run_select(view, cmd, &output, cache.max_bytes());
+    }
+    
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    
+    if (result == 0 && !output.empty()) {
+        cache.put(key, output);
+    }
+    return result;
+}
+
+// Streams a table, or its committed version with --at, to stdout
+int run_export(vsdb::Database& db, const vsdb::ParsedCommand& cmd) {
+    auto format = vsdb::parse_export_format(cmd.export_format);
+    if (!format) {
+        std::cerr << "Error: Unknown format '" << cmd.export_format << "' (expected csv, jsonl or binary)\n";
+        return 1;
+    }
+    
+    vsdb::ExportOptions options;
+    options.format = *format;
+    if (cmd.threads) {
+        options.threads = *cmd.threads;
+    }
+    
+    auto export_from = [&](vsdb::Database& source) {
+        auto table = source.get_table(cmd.table_name);
+        if (!table) {
+            std::cerr << "Error: Table '" << cmd.table_name << "' not found\n";
+            return 1;
+        }
+        
+        size_t rows = 0;
+        if (vsdb::Status status = vsdb::export_table(*table, options, std::cout, &rows); !status) {
+            return report_error(status);
+        }
+        std::cerr << rows << " rows exported\n";
+        return 0;
+    };
+    
+    if (cmd.at_commit.empty()) {
+        return export_from(db);
+    }
+    
+    std::string commit;
+    if (vsdb::Status status = db.resolve_commit(cmd.at_commit, &commit); !status) {
+        return report_error(status);
+    }
+    
+    auto root = db.get_temp_dir() /
+        ("export-" + commit + "-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    
+    int result = 1;
+    if (vsdb::Status status = db.materialize(commit, {cmd.table_name}, root); !status) {
+        result = report_error(status);
+    } else {
+        vsdb::Database view(root);
+        result = export_from(view);
+    }
+    
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    return result;
+}
+
+// Split a script line into arguments. Single or double quotes group
+// words; returns false on an unterminated quote.
+bool split_command_line(const std::string& line, std::vector<std::string>& args) {
+    args.clear();
+    std::string current;
+    bool in_word = false;
+    char quote = 0;
+    
+    for (char c : line) {
+        if (quote) {
+            if (c == quote) {
+                quote = 0;
+            } else {
+                current += c;
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            in_word = true;
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            if (in_word) {
+                args.push_back(std::move(current));
+                current.clear();
+                in_word = false;
+            }
+        } else {
+            current += c;
+            in_word = true;
+        }
+    }
+    
+    if (in_word) {
+        args.push_back(std::move(current));
+    }
+    return quote == 0;
+}
+
+int run_command(vsdb::Database& db, const vsdb::ParsedCommand& cmd);
+
+// Runs each line of a script as a command against one Database, with
+// table writes deferred until a commit or the end of the script
+int run_script(vsdb::Database& db, const vsdb::ParsedCommand& cmd) {
+    std::ifstream file;
+    if (cmd.script_path != "-") {
+        file.open(cmd.script_path);
+        if (!file.is_open()) {
+            std::cerr << "Error: Cannot open script '" << cmd.script_path << "'\n";
+            return 1;
+        }
+    }
+    std::istream& in = (cmd.script_path == "-") ? std::cin : file;
+    
+    db.set_deferred_writes(true);
+    
     vsdb::CLIParser parser;
-    vsdb::ParsedCommand cmd = parser.parse(argc, argv);
+    std::string line;
+    std::vector<std::string> args;
+    size_t line_no = 0;
+    size_t succeeded = 0;
+    size_t failed = 0;
     
-    vsdb::Database db;
+    while (std::getline(in, line)) {
+        line_no++;
+        if (!split_command_line(line, args)) {
+            std::cerr << "line " << line_no << ": Error: Unterminated quote\n";
+            failed++;
+            if (!cmd.keep_going) break;
+            continue;
+        }
+        if (args.empty() || args[0][0] == '#') continue;
+        
+        std::vector<char*> argv;
+        std::string program = "vsdb";
+        argv.push_back(program.data());
+        for (auto& arg : args) {
+            argv.push_back(arg.data());
+        }
+        
+        vsdb::ParsedCommand line_cmd = parser.parse(static_cast<int>(argv.size()), argv.data());
+        
+        int status = 1;
+        if (line_cmd.cmd == vsdb::Command::EXEC) {
+            std::cerr << "Error: exec cannot be nested\n";
+        } else if (line_cmd.cmd != vsdb::Command::NONE) {
+            status = run_command(db, line_cmd);
+        }
+        
+        if (status == 0) {
+            succeeded++;
+        } else {
+            std::cerr << "line " << line_no << ": failed: " << line << "\n";
+            failed++;
+            if (!cmd.keep_going) break;
+        }
+    }
+    
+    if (vsdb::Status status = db.flush(); !status) {
+        report_error(status);
+        failed++;
+    }
     
+    std::cout << "Executed " << (succeeded + failed) << " commands: "
+              << succeeded << " succeeded, " << failed << " failed\n";
+    return failed == 0 ? 0 : 1;
+}
+
+int run_command(vsdb::Database& db, const vsdb::ParsedCommand& cmd) {
     switch (cmd.cmd) {
         case vsdb::Command::INIT:
-            if (db.initialize()) {
-                return 0;
-            } else {
-                return 1;
+            if (vsdb::Status status = db.initialize(); !status) {
+                return report_error(status);
             }
+            std::cout << "Database initialized successfully in " << db.get_db_path() << "\n";
+            std::cout << "Created directories:\n";
+            std::cout << "  - data/      (for table data storage)\n";
+            std::cout << "  - objects/   (for version control objects)\n";
+            return 0;
             
         case vsdb::Command::CREATE_TABLE: {
             if (!db.is_initialized()) {
@@ -77,11 +552,22 @@ int main(int argc, char** argv) {
                 return 1;
             }
             
+            vsdb::StorageType storage;
+            if (cmd.storage == "memory") {
+                storage = vsdb::StorageType::MEMORY;
+            } else if (cmd.storage == "paged") {
+                storage = vsdb::StorageType::PAGED;
+            } else {
+                std::cerr << "Error: Unknown storage '" << cmd.storage << "' (expected memory or paged)\n";
+                return 1;
+            }
+            
             auto columns = parse_columns(cmd.columns);
-            if (db.create_table(cmd.table_name, columns)) {
-                return 0;
+            if (vsdb::Status status = db.create_table(cmd.table_name, columns, storage); !status) {
+                return report_error(status);
             }
-            return 1;
+            std::cout << "Table '" << cmd.table_name << "' created successfully\n";
+            return 0;
         }
             
         case vsdb::Command::INSERT: {
@@ -98,40 +584,84 @@ int main(int argc, char** argv) {
             vsdb::Record record;
             record.values = cmd.values;
             
-            if (db.insert_into(cmd.table_name, record)) {
-                std::cout << "Inserted 1 row into '" << cmd.table_name << "'\n";
-                return 0;
+            if (vsdb::Status status = db.insert_into(cmd.table_name, record); !status) {
+                return report_error(status);
             }
-            return 1;
+            std::cout << "Inserted 1 row into '" << cmd.table_name << "'\n";
+            return 0;
         }
             
-        case vsdb::Command::SELECT: {
+        case vsdb::Command::SELECT:
             if (!db.is_initialized()) {
                 std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
                 return 1;
             }
+            if (!cmd.at_commit.empty()) {
+                return run_select_at(db, cmd);
+            }
+            return run_select(db, cmd);
             
-            auto table = db.get_table(cmd.table_name);
-            if (!table) {
-                std::cerr << "Error: Table '" << cmd.table_name << "' not found\n";
+        case vsdb::Command::UPDATE: {
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
                 return 1;
             }
             
-            auto records = db.select_from(cmd.table_name);
-            print_table(table->get_schema(), records);
-            std::cout << "\n" << records.size() << " rows returned\n";
+            std::vector<vsdb::Predicate> predicates;
+            if (!parse_filters(cmd.filters, predicates)) {
+                return 1;
+            }
+            
+            std::vector<vsdb::Assignment> assignments;
+            for (const auto& expr : cmd.assignments) {
+                auto assignment = vsdb::Assignment::parse(expr);
+                if (!assignment) {
+                    std::cerr << "Error: Invalid assignment '" << expr << "' (expected column=value)\n";
+                    return 1;
+                }
+                assignments.push_back(*assignment);
+            }
+            
+            size_t count = 0;
+            if (vsdb::Status status = db.update(cmd.table_name, predicates, assignments, &count); !status) {
+                return report_error(status);
+            }
+            std::cout << "Updated " << count << " rows in '" << cmd.table_name << "'\n";
             return 0;
         }
             
-        case vsdb::Command::COMMIT:
+        case vsdb::Command::DELETE: {
             if (!db.is_initialized()) {
                 std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
                 return 1;
             }
-            if (db.commit(cmd.commit_message).empty()) {
+            
+            std::vector<vsdb::Predicate> predicates;
+            if (!parse_filters(cmd.filters, predicates)) {
+                return 1;
+            }
+            
+            size_t count = 0;
+            if (vsdb::Status status = db.delete_from(cmd.table_name, predicates, &count); !status) {
+                return report_error(status);
+            }
+            std::cout << "Deleted " << count << " rows from '" << cmd.table_name << "'\n";
+            return 0;
+        }
+            
+        case vsdb::Command::COMMIT: {
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
                 return 1;
             }
+            std::string hash;
+            if (vsdb::Status status = db.commit(cmd.commit_message, &hash); !status) {
+                return report_error(status);
+            }
+            std::cout << "Committed successfully\n";
+            std::cout << "Commit hash: " << hash << "\n";
             return 0;
+        }
             
         case vsdb::Command::LOG: {
             if (!db.is_initialized()) {
@@ -159,10 +689,215 @@ int main(int argc, char** argv) {
                 std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
                 return 1;
             }
-            if (db.checkout(cmd.commit_hash)) {
-                return 0;
+            if (vsdb::Status status = db.checkout(cmd.commit_hash); !status) {
+                return report_error(status);
+            }
+            std::cout << "Checked out commit " << cmd.commit_hash << "\n";
+            return 0;
+            
+        case vsdb::Command::CREATE_INDEX:
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            if (vsdb::Status status = db.create_index(cmd.table_name, cmd.index_column); !status) {
+                return report_error(status);
+            }
+            std::cout << "Index created on '" << cmd.table_name << "(" << cmd.index_column << ")'\n";
+            return 0;
+        
+        case vsdb::Command::ADD_COLUMN: {
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            
+            vsdb::Column column = parse_columns(cmd.columns).front();
+            column.default_value = cmd.default_value;
+            if (vsdb::Status status = db.add_column(cmd.table_name, column); !status) {
+                return report_error(status);
+            }
+            std::cout << "Column '" << column.name << "' added to '" << cmd.table_name << "'\n";
+            return 0;
+        }
+        
+        case vsdb::Command::EXPORT:
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            return run_export(db, cmd);
+            
+        case vsdb::Command::DROP_COLUMN:
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            if (vsdb::Status status = db.drop_column(cmd.table_name, cmd.column_name); !status) {
+                return report_error(status);
+            }
+            std::cout << "Column '" << cmd.column_name << "' dropped from '" << cmd.table_name << "'\n";
+            return 0;
+        
+        case vsdb::Command::STATS: {
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            
+            if (auto objects = db.get_object_stats()) {
+                std::cout << "Object store:\n";
+                std::cout << "  objects: " << objects->object_count << "\n";
+                std::cout << "  bytes:   " << objects->total_bytes << "\n";
+                std::cout << "  commits: " << objects->commit_count << "\n\n";
+            }
+            
+            auto tables = db.get_table_stats();
+            std::cout << "Tables: " << tables.size() << "\n";
+            for (const auto& t : tables) {
+                std::cout << "  " << t.name
+                          << "\trows=" << t.row_count
+                          << "\tcolumns=" << t.column_count
+                          << "\tschema=v" << t.schema_version
+                          << "\tbytes=" << t.data_bytes << "\n";
+            }
+            return 0;
+        }
+            
+        case vsdb::Command::PRUNE: {
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            
+            vsdb::RetentionPolicy policy{cmd.keep_last, cmd.keep_days};
+            vsdb::PruneStats stats;
+            if (vsdb::Status status = db.prune(policy, cmd.dry_run, &stats); !status) {
+                return report_error(status);
+            }
+            
+            std::cout << (cmd.dry_run ? "Would keep " : "Kept ") << stats.commits_kept << " commits, "
+                      << (cmd.dry_run ? "squash " : "squashed ") << stats.commits_squashed << "\n";
+            std::cout << (cmd.dry_run ? "Would remove " : "Removed ") << stats.objects_removed
+                      << " objects (" << stats.bytes_freed << " bytes)\n";
+            if (stats.commits_squashed > 0 && !stats.head.empty()) {
+                std::cout << (cmd.dry_run ? "HEAD would be " : "HEAD is now ") << stats.head << "\n";
+            }
+            return 0;
+        }
+            
+        case vsdb::Command::WORKTREE_ADD: {
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            std::string hash;
+            if (vsdb::Status status = db.add_worktree(cmd.worktree_dir, cmd.commit_hash, &hash); !status) {
+                return report_error(status);
+            }
+            std::cout << "Worktree " << cmd.worktree_dir << " at commit " << hash << " (read-only)\n";
+            std::cout << "Query it with: vsdb --db " << cmd.worktree_dir << " select <table>\n";
+            return 0;
+        }
+            
+        case vsdb::Command::WORKTREE_LIST: {
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            auto worktrees = db.get_worktrees();
+            if (worktrees.empty()) {
+                std::cout << "No worktrees\n";
+            }
+            for (const auto& worktree : worktrees) {
+                std::cout << worktree.dir.string() << "\t" << worktree.commit << "\n";
+            }
+            return 0;
+        }
+            
+        case vsdb::Command::WORKTREE_REMOVE:
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            if (vsdb::Status status = db.remove_worktree(cmd.worktree_dir); !status) {
+                return report_error(status);
+            }
+            std::cout << "Removed worktree " << cmd.worktree_dir << "\n";
+            return 0;
+            
+        case vsdb::Command::FSCK: {
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            
+            vsdb::FsckOptions options;
+            options.full = cmd.full_check;
+            if (cmd.threads) {
+                options.threads = std::max<size_t>(1, *cmd.threads);
+            }
+            vsdb::FsckReport report;
+            if (vsdb::Status status = db.fsck(options, &report); !status) {
+                return report_error(status);
             }
-            return 1;
+            
+            for (const auto& id : report.corrupt) {
+                std::cout << "corrupt object " << id << "\n";
+            }
+            for (const auto& missing : report.missing) {
+                std::cout << "missing " << missing << "\n";
+            }
+            std::cout << "Checked " << report.objects_checked << " objects ("
+                      << report.objects_skipped << " unchanged since the last check), "
+                      << report.commits_checked << " commits\n";
+            std::cout << (report.ok() ? "No problems found\n" : "Object store is damaged\n");
+            return report.ok() ? 0 : 1;
+        }
+            
+        case vsdb::Command::PROVE: {
+            if (!db.is_initialized()) {
+                std::cerr << "Error: Database not initialized. Run 'vsdb init' first.\n";
+                return 1;
+            }
+            
+            vsdb::RowProof proof;
+            if (vsdb::Status status = db.prove_row(cmd.table_name, cmd.row_id, cmd.at_commit, &proof);
+                !status) {
+                return report_error(status);
+            }
+            
+            auto print_path = [](const char* name, const std::vector<vsdb::MerkleStep>& path) {
+                std::cout << name << ":\n";
+                for (const auto& step : path) {
+                    std::cout << "  " << (step.sibling_left ? "L " : "R ") << step.sibling << "\n";
+                }
+            };
+            
+            std::cout << "commit:   " << proof.commit << "\n";
+            std::cout << "row:      " << proof.table << "[" << proof.row_id << "] = ";
+            if (proof.row) {
+                for (size_t i = 0; i < proof.row->values.size(); ++i) {
+                    std::cout << (i ? ", " : "") << proof.row->values[i];
+                }
+                std::cout << "\n";
+            } else {
+                std::cout << "(deleted)\n";
+            }
+            print_path("block", proof.block_path);
+            print_path("table", proof.table_path);
+            std::cout << "rows root: " << proof.row_root << "\n";
+            print_path("tree", proof.tree_path);
+            std::cout << "tree root: " << proof.tree_root << "\n";
+            
+            bool valid = proof.verify();
+            std::cout << (valid ? "Verified" : "Proof does NOT match the commit") << " ("
+                      << proof.hash_count() << " hashes)\n";
+            return valid ? 0 : 1;
+        }
+            
+        case vsdb::Command::EXEC:
+            return run_script(db, cmd);
             
         case vsdb::Command::NONE:
         default:
@@ -171,4 +906,36 @@ int main(int argc, char** argv) {
     }
     
     return 0;
+}
+
+int main(int argc, char** argv) {
+    vsdb::CLIParser parser;
+    vsdb::ParsedCommand cmd = parser.parse(argc, argv);
+    
+    if (!cmd.trace_path.empty()) {
+        vsdb::Tracer::instance().start(cmd.trace_path);
+    }
+    
+    int status;
+    {
+        vsdb::ScopedTimer timer(vsdb::Timer::COMMAND);
+        // Selects and exports over a commit, proofs and fsck read only the object store
+        vsdb::OpenOptions options;
+        options.open_tables = cmd.cmd != vsdb::Command::FSCK && cmd.cmd != vsdb::Command::PROVE &&
+                              ((cmd.cmd != vsdb::Command::SELECT && cmd.cmd != vsdb::Command::EXPORT) ||
+                               cmd.at_commit.empty());
+        
+        vsdb::Database db(cmd.db_path.empty() ? std::filesystem::current_path()
+                                              : std::filesystem::path(cmd.db_path), options);
+        status = run_command(db, cmd);
+    }
+    
+    if (cmd.show_stats) {
+        vsdb::Metrics::instance().report(std::cerr);
+    }
+    if (vsdb::Tracer::enabled() && !vsdb::Tracer::instance().flush()) {
+        std::cerr << "Warning: Failed to write the trace\n";
+    }
+    
+    return status;
 }
\ No newline at end of file
@@ -0,0 +1,473 @@
+#include "query/aggregate.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+namespace vsdb {
+
+namespace {
+
+std::string format_double(double value) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.15g", value);
+    return buf;
+}
+
+bool is_numeric(DataType type) {
+    return type == DataType::INT || type == DataType::FLOAT || type == DataType::BOOL;
+}
+
+} // namespace
+
+std::optional<AggregateSpec> AggregateSpec::parse(const std::string& expr) {
+    size_t open = expr.find('(');
+    size_t close = expr.rfind(')');
+    if (open == std::string::npos || close == std::string::npos || close < open) {
+        return std::nullopt;
+    }
+    
+    std::string func = expr.substr(0, open);
+    std::transform(func.begin(), func.end(), func.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    
+    AggregateSpec spec;
+    spec.column = expr.substr(open + 1, close - open - 1);
+    
+    if (func == "count") {
+        spec.func = AggregateFunc::COUNT;
+        if (spec.column == "*") spec.column.clear();
+    } else if (func == "sum") {
+        spec.func = AggregateFunc::SUM;
+    } else if (func == "min") {
+        spec.func = AggregateFunc::MIN;
+    } else if (func == "max") {
+        spec.func = AggregateFunc::MAX;
+    } else if (func == "avg") {
+        spec.func = AggregateFunc::AVG;
+    } else {
+        return std::nullopt;
+    }
+    
+    if (spec.func != AggregateFunc::COUNT && spec.column.empty()) {
+        return std::nullopt;
+    }
+    
+    return spec;
+}
+
+std::string AggregateSpec::label() const {
+    static const char* names[] = {"count", "sum", "min", "max", "avg"};
+    return std::string(names[static_cast<int>(func)]) + "(" + (column.empty() ? "*" : column) + ")";
+}
+
+// Running state of one aggregate within one group
+struct Aggregator::State {
+    int64_t count = 0;
+    int64_t int_sum = 0;
+    int64_t int_min = std::numeric_limits<int64_t>::max();
+    int64_t int_max = std::numeric_limits<int64_t>::min();
+    double float_sum = 0.0;
+    double float_min = std::numeric_limits<double>::infinity();
+    double float_max = -std::numeric_limits<double>::infinity();
+    std::string text_min;
+    std::string text_max;
+};
+
+// Private hash table of one worker: group key -> slot, states[slot * n + agg]
+struct Aggregator::Partial {
+    std::unordered_map<std::string, size_t> slots;
+    std::vector<size_t> code_slots; // Single coded group column: code -> slot + 1
+    std::vector<std::vector<std::string>> group_values;
+    std::vector<State> states;
+};
+
+Aggregator::Aggregator(const TableSchema& schema,
+                       std::vector<AggregateSpec> aggregates,
+                       std::vector<std::string> group_by)
+    : schema_(schema), aggregates_(std::move(aggregates)), group_by_(std::move(group_by)) {
+    for (const auto& spec : aggregates_) {
+        agg_columns_.push_back(spec.column.empty() ? std::nullopt : schema_.find_column(spec.column));
+    }
+    for (const auto& name : group_by_) {
+        group_columns_.push_back(schema_.find_column(name));
+    }
+}
+
+Status Aggregator::validate() const {
+    for (size_t i = 0; i < aggregates_.size(); ++i) {
+        const auto& spec = aggregates_[i];
+        if (spec.column.empty()) continue;
+        
+        if (!agg_columns_[i]) {
+            return Status::error("Unknown column '" + spec.column + "'");
+        }
+        
+        DataType type = schema_.columns[*agg_columns_[i]].type;
+        if ((spec.func == AggregateFunc::SUM || spec.func == AggregateFunc::AVG) && !is_numeric(type)) {
+            return Status::error(spec.label() + " requires a numeric column");
+        }
+    }
+    
+    for (size_t i = 0; i < group_by_.size(); ++i) {
+        if (!group_columns_[i]) {
+            return Status::error("Unknown column '" + group_by_[i] + "'");
+        }
+    }
+    
+    return Status::ok();
+}
+
+void Aggregator::aggregate_range(const std::vector<Record>& rows, size_t begin, size_t end,
+                                 Partial& partial, const GroupCodes* codes) const {
+    const size_t num_aggs = aggregates_.size();
+    const bool single_code = codes && codes->size() == 1 && (*codes)[0];
+    
+    std::vector<size_t> slots(kBatchSize);
+    std::vector<int64_t> ints(kBatchSize);
+    std::vector<double> floats(kBatchSize);
+    std::vector<char> present(kBatchSize);
+    std::string key;
+    
+    auto new_slot = [&](const Record& record) {
+        std::vector<std::string> values;
+        for (const auto& col : group_columns_) {
+            values.push_back(record.values[*col]);
+        }
+        partial.group_values.push_back(std::move(values));
+        partial.states.resize(partial.states.size() + num_aggs);
+        return partial.group_values.size() - 1;
+    };
+    
+    // Group key: codes as 4 raw bytes, strings followed by a separator
+    auto make_key = [&](size_t row) {
+        key.clear();
+        for (size_t g = 0; g < group_columns_.size(); ++g) {
+            if (codes && (*codes)[g]) {
+                uint32_t code = (*(*codes)[g])[row];
+                key.append(reinterpret_cast<const char*>(&code), sizeof(code));
+            } else {
+                key += rows[row].values[*group_columns_[g]];
+                key += '\x1f';
+            }
+        }
+    };
+    
+    for (size_t batch = begin; batch < end; batch += kBatchSize) {
+        const size_t n = std::min(kBatchSize, end - batch);
+        
+        // Resolve the group slot of every row in the batch
+        for (size_t i = 0; i < n; ++i) {
+            const size_t row = batch + i;
+            
+            if (single_code) {
+                // Dense code -> slot table, no hashing
+                uint32_t code = (*(*codes)[0])[row];
+                if (code >= partial.code_slots.size()) {
+                    partial.code_slots.resize(code + 1, 0);
+                }
+                if (partial.code_slots[code] == 0) {
+                    make_key(row);
+                    partial.slots.emplace(key, partial.group_values.size());
+                    partial.code_slots[code] = new_slot(rows[row]) + 1;
+                }
+                slots[i] = partial.code_slots[code] - 1;
+                continue;
+            }
+            
+            make_key(row);
+            auto it = partial.slots.find(key);
+            if (it == partial.slots.end()) {
+                it = partial.slots.emplace(key, new_slot(rows[row])).first;
+            }
+            slots[i] = it->second;
+        }
+        
+        // Update each aggregate from a decoded column vector. Empty values
+        // are NULL: only count(*) sees them.
+        for (size_t a = 0; a < num_aggs; ++a) {
+            if (!agg_columns_[a]) {
+                for (size_t i = 0; i < n; ++i) {
+                    partial.states[slots[i] * num_aggs + a].count++;
+                }
+                continue;
+            }
+            
+            const size_t col = *agg_columns_[a];
+            for (size_t i = 0; i < n; ++i) {
+                present[i] = !rows[batch + i].values[col].empty();
+            }
+            
+            if (aggregates_[a].func == AggregateFunc::COUNT) {
+                for (size_t i = 0; i < n; ++i) {
+                    partial.states[slots[i] * num_aggs + a].count += present[i];
+                }
+                continue;
+            }
+            
+            switch (schema_.columns[col].type) {
+                case DataType::INT:
+                case DataType::BOOL: {
+                    if (schema_.columns[col].type == DataType::INT) {
+                        for (size_t i = 0; i < n; ++i) {
+                            ints[i] = std::strtoll(rows[batch + i].values[col].c_str(), nullptr, 10);
+                        }
+                    } else {
+                        for (size_t i = 0; i < n; ++i) {
+                            ints[i] = TypedValue::parse(DataType::BOOL, rows[batch + i].values[col]).int_value;
+                        }
+                    }
+                    for (size_t i = 0; i < n; ++i) {
+                        if (!present[i]) continue;
+                        State& s = partial.states[slots[i] * num_aggs + a];
+                        s.count++;
+                        s.int_sum += ints[i];
+                        s.int_min = std::min(s.int_min, ints[i]);
+                        s.int_max = std::max(s.int_max, ints[i]);
+                    }
+                    break;
+                }
+                case DataType::FLOAT: {
+                    for (size_t i = 0; i < n; ++i) {
+                        floats[i] = std::strtod(rows[batch + i].values[col].c_str(), nullptr);
+                    }
+                    for (size_t i = 0; i < n; ++i) {
+                        if (!present[i]) continue;
+                        State& s = partial.states[slots[i] * num_aggs + a];
+                        s.count++;
+                        s.float_sum += floats[i];
+                        s.float_min = std::min(s.float_min, floats[i]);
+                        s.float_max = std::max(s.float_max, floats[i]);
+                    }
+                    break;
+                }
+                case DataType::TEXT: {
+                    for (size_t i = 0; i < n; ++i) {
+                        if (!present[i]) continue;
+                        State& s = partial.states[slots[i] * num_aggs + a];
+                        const std::string& value = rows[batch + i].values[col];
+                        if (s.count == 0 || value < s.text_min) s.text_min = value;
+                        if (s.count == 0 || value > s.text_max) s.text_max = value;
+                        s.count++;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void Aggregator::merge(Partial& into, const Partial& from) const {
+    const size_t num_aggs = aggregates_.size();
+    
+    for (const auto& [key, from_slot] : from.slots) {
+        auto [it, inserted] = into.slots.try_emplace(key, into.group_values.size());
+        if (inserted) {
+            into.group_values.push_back(from.group_values[from_slot]);
+            into.states.insert(into.states.end(),
+                               from.states.begin() + from_slot * num_aggs,
+                               from.states.begin() + (from_slot + 1) * num_aggs);
+            continue;
+        }
+        
+        for (size_t a = 0; a < num_aggs; ++a) {
+            State& dst = into.states[it->second * num_aggs + a];
+            const State& src = from.states[from_slot * num_aggs + a];
+            
+            if (src.count == 0) continue;
+            if (dst.count == 0 || src.text_min < dst.text_min) dst.text_min = src.text_min;
+            if (dst.count == 0 || src.text_max > dst.text_max) dst.text_max = src.text_max;
+            
+            dst.count += src.count;
+            dst.int_sum += src.int_sum;
+            dst.int_min = std::min(dst.int_min, src.int_min);
+            dst.int_max = std::max(dst.int_max, src.int_max);
+            dst.float_sum += src.float_sum;
+            dst.float_min = std::min(dst.float_min, src.float_min);
+            dst.float_max = std::max(dst.float_max, src.float_max);
+        }
+    }
+}
+
+std::string Aggregator::finalize(const AggregateSpec& spec, DataType type, const State& state) const {
+    if (spec.func == AggregateFunc::COUNT) {
+        return std::to_string(state.count);
+    }
+    
+    bool is_float = (type == DataType::FLOAT);
+    
+    switch (spec.func) {
+        case AggregateFunc::SUM:
+            if (state.count == 0) return "";
+            return is_float ? format_double(state.float_sum) : std::to_string(state.int_sum);
+        case AggregateFunc::AVG:
+            if (state.count == 0) return "";
+            return format_double((is_float ? state.float_sum : static_cast<double>(state.int_sum)) / state.count);
+        case AggregateFunc::MIN:
+        case AggregateFunc::MAX: {
+            if (state.count == 0) return "";
+            bool is_min = (spec.func == AggregateFunc::MIN);
+            if (type == DataType::TEXT) return is_min ? state.text_min : state.text_max;
+            if (is_float) return format_double(is_min ? state.float_min : state.float_max);
+            return std::to_string(is_min ? state.int_min : state.int_max);
+        }
+        default:
+            return "";
+    }
+}
+
+AggregateResult Aggregator::run(const std::vector<Record>& rows, size_t threads) const {
+    size_t max_parts = std::max<size_t>(rows.size() / kMinRowsPerPartition, 1);
+    auto ranges = partition_range(rows.size(), std::min(threads, max_parts));
+    
+    std::vector<Partial> partials(ranges.size());
+    
+    if (ranges.size() == 1) {
+        aggregate_range(rows, ranges[0].first, ranges[0].second, partials[0]);
+    } else {
+        ThreadPool pool(ranges.size());
+        std::vector<std::future<void>> pending;
+        
+        for (size_t p = 0; p < ranges.size(); ++p) {
+            pending.push_back(pool.submit([&, p]() {
+                aggregate_range(rows, ranges[p].first, ranges[p].second, partials[p]);
+            }));
+        }
+        for (auto& f : pending) {
+            f.get();
+        }
+    }
+    
+    return finish(partials);
+}
+
+AggregateResult Aggregator::run(const BatchSource& source, size_t threads) const {
+    std::vector<Partial> partials(std::max<size_t>(threads, 1));
+    std::mutex source_mutex;
+    
+    auto worker = [&](Partial& partial) {
+        std::vector<Record> batch;
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(source_mutex);
+                if (!source(batch)) return;
+            }
+            aggregate_range(batch, 0, batch.size(), partial);
+        }
+    };
+    
+    if (partials.size() == 1) {
+        worker(partials[0]);
+    } else {
+        ThreadPool pool(partials.size());
+        std::vector<std::future<void>> pending;
+        for (auto& partial : partials) {
+            pending.push_back(pool.submit([&]() { worker(partial); }));
+        }
+        for (auto& f : pending) {
+            f.get();
+        }
+    }
+    
+    return finish(partials);
+}
+
+AggregateResult Aggregator::run(TableCursor& cursor, size_t threads) const {
+    std::vector<size_t> columns;
+    for (const auto& col : group_columns_) {
+        columns.push_back(*col);
+    }
+    cursor.request_codes(columns);
+    
+    std::vector<Partial> partials(std::max<size_t>(threads, 1));
+    std::mutex cursor_mutex;
+    
+    auto worker = [&](Partial& partial) {
+        std::vector<Record> batch;
+        std::vector<std::vector<uint32_t>> codes(columns.size());
+        GroupCodes group_codes(columns.size(), nullptr);
+        
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(cursor_mutex);
+                if (!cursor.next_batch(batch)) return;
+                
+                for (size_t g = 0; g < columns.size(); ++g) {
+                    const auto* batch_codes = cursor.batch_codes(g);
+                    if (batch_codes) codes[g] = *batch_codes;
+                    group_codes[g] = batch_codes ? &codes[g] : nullptr;
+                }
+            }
+            aggregate_range(batch, 0, batch.size(), partial, &group_codes);
+        }
+    };
+    
+    if (partials.size() == 1) {
+        worker(partials[0]);
+    } else {
+        ThreadPool pool(partials.size());
+        std::vector<std::future<void>> pending;
+        for (auto& partial : partials) {
+            pending.push_back(pool.submit([&]() { worker(partial); }));
+        }
+        for (auto& f : pending) {
+            f.get();
+        }
+    }
+    
+    return finish(partials);
+}
+
+AggregateResult Aggregator::finish(std::vector<Partial>& partials) const {
+    for (size_t p = 1; p < partials.size(); ++p) {
+        merge(partials[0], partials[p]);
+    }
+    Partial& total = partials[0];
+    
+    // A global aggregate always yields one row, even over no input
+    if (group_by_.empty() && total.group_values.empty()) {
+        total.slots.emplace("", 0);
+        total.group_values.emplace_back();
+        total.states.resize(aggregates_.size());
+    }
+    
+    // Order groups by their typed group-by values
+    std::vector<size_t> order(total.group_values.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        for (size_t g = 0; g < group_columns_.size(); ++g) {
+            DataType type = schema_.columns[*group_columns_[g]].type;
+            int cmp = TypedValue::parse(type, total.group_values[a][g])
+                          .compare(TypedValue::parse(type, total.group_values[b][g]));
+            if (cmp != 0) return cmp < 0;
+        }
+        return false;
+    });
+    
+    AggregateResult result;
+    result.columns = group_by_;
+    for (const auto& spec : aggregates_) {
+        result.columns.push_back(spec.label());
+    }
+    
+    const size_t num_aggs = aggregates_.size();
+    for (size_t slot : order) {
+        Record record;
+        record.values = total.group_values[slot];
+        
+        for (size_t a = 0; a < num_aggs; ++a) {
+            DataType type = agg_columns_[a] ? schema_.columns[*agg_columns_[a]].type : DataType::INT;
+            record.values.push_back(finalize(aggregates_[a], type, total.states[slot * num_aggs + a]));
+        }
+        
+        result.rows.push_back(std::move(record));
+    }
+    
+    return result;
+}
+
+} // namespace vsdb
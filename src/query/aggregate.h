@@ -0,0 +1,81 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "db/database.h"
+#include "util/thread_pool.h"
+
+namespace vsdb {
+
+enum class AggregateFunc {
+    COUNT,
+    SUM,
+    MIN,
+    MAX,
+    AVG
+};
+
+// One output aggregate, e.g. "count(*)" or "sum(amount)"
+struct AggregateSpec {
+    AggregateFunc func = AggregateFunc::COUNT;
+    std::string column; // Empty for count(*)
+    
+    static std::optional<AggregateSpec> parse(const std::string& expr);
+    std::string label() const;
+};
+
+struct AggregateResult {
+    std::vector<std::string> columns;
+    std::vector<Record> rows;
+};
+
+// Hash aggregation over column batches. Each worker decodes its rows a
+// batch at a time into typed column vectors and aggregates them into a
+// private hash table; the partial tables are merged once all workers
+// finish. In-memory input is split into one contiguous partition per
+// worker, streamed input is handed out to workers batch by batch.
+class Aggregator {
+public:
+    static constexpr size_t kBatchSize = 1024;
+    static constexpr size_t kMinRowsPerPartition = 16 * 1024;
+    
+    Aggregator(const TableSchema& schema,
+               std::vector<AggregateSpec> aggregates,
+               std::vector<std::string> group_by);
+    
+    // Checks that columns exist and suit their functions
+    Status validate() const;
+    
+    AggregateResult run(const std::vector<Record>& rows,
+                        size_t threads = ThreadPool::default_threads()) const;
+    AggregateResult run(const BatchSource& source,
+                        size_t threads = ThreadPool::default_threads()) const;
+    
+    // Scan a table; dictionary-encoded group-by columns are grouped on
+    // their integer codes instead of their strings
+    AggregateResult run(TableCursor& cursor,
+                        size_t threads = ThreadPool::default_threads()) const;
+    
+private:
+    struct State;
+    struct Partial;
+    
+    const TableSchema& schema_;
+    std::vector<AggregateSpec> aggregates_;
+    std::vector<std::string> group_by_;
+    
+    std::vector<std::optional<size_t>> agg_columns_;
+    std::vector<std::optional<size_t>> group_columns_;
+    
+    // Per group column: codes aligned with the rows, or null if not encoded
+    using GroupCodes = std::vector<const std::vector<uint32_t>*>;
+    
+    void aggregate_range(const std::vector<Record>& rows, size_t begin, size_t end, Partial& partial,
+                         const GroupCodes* codes = nullptr) const;
+    void merge(Partial& into, const Partial& from) const;
+    std::string finalize(const AggregateSpec& spec, DataType type, const State& state) const;
+    AggregateResult finish(std::vector<Partial>& partials) const;
+};
+
+} // namespace vsdb
@@ -0,0 +1,412 @@
+#include "query/hash_join.h"
+#include "query/spill_file.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace vsdb {
+
+namespace {
+
+// Type both key columns are compared as
+DataType key_type(DataType left, DataType right) {
+    if (left == right) return left;
+    if (left == DataType::FLOAT || right == DataType::FLOAT) return DataType::FLOAT;
+    return DataType::INT;
+}
+
+bool is_numeric(DataType type) {
+    return type != DataType::TEXT;
+}
+
+// Estimated memory of a hash table entry beyond the record itself
+constexpr size_t kEntryOverhead = 64;
+
+constexpr size_t kSpillPartitions = size_t(1) << HashJoin::kSpillPartitionBits;
+
+// Each split level partitions on the next bits of the key hash
+size_t partition_of(const std::string& key, size_t level) {
+    return (std::hash<std::string>()(key) >> (level * HashJoin::kSpillPartitionBits)) &
+           (kSpillPartitions - 1);
+}
+
+BatchSource read_spill(const std::filesystem::path& path) {
+    auto reader = std::make_shared<SpillReader>(path);
+    return [reader](std::vector<Record>& batch) {
+        batch.clear();
+        Record record;
+        while (batch.size() < TableCursor::kDefaultBatchSize && reader->next(record)) {
+            batch.push_back(std::move(record));
+        }
+        return !batch.empty();
+    };
+}
+
+} // namespace
+
+std::optional<JoinSpec> JoinSpec::parse(const std::string& expr,
+                                        const std::string& left_table,
+                                        const std::string& right_table) {
+    size_t eq = expr.find('=');
+    if (eq == std::string::npos) {
+        return std::nullopt;
+    }
+    
+    auto split = [](const std::string& side) {
+        size_t dot = side.find('.');
+        if (dot == std::string::npos) {
+            return std::make_pair(std::string(), side);
+        }
+        return std::make_pair(side.substr(0, dot), side.substr(dot + 1));
+    };
+    
+    auto [first_table, first_col] = split(expr.substr(0, eq));
+    auto [second_table, second_col] = split(expr.substr(eq + 1));
+    
+    JoinSpec spec;
+    if (first_table == right_table && second_table != right_table) {
+        spec.left_column = second_col;
+        spec.right_column = first_col;
+    } else {
+        spec.left_column = first_col;
+        spec.right_column = second_col;
+    }
+    
+    if ((!first_table.empty() && first_table != left_table && first_table != right_table) ||
+        (!second_table.empty() && second_table != left_table && second_table != right_table)) {
+        return std::nullopt;
+    }
+    
+    return spec;
+}
+
+HashJoin::HashJoin(const TableSchema& left, const TableSchema& right, JoinSpec spec)
+    : left_(left), right_(right), spec_(std::move(spec)) {
+    left_key_ = left_.find_column(spec_.left_column);
+    right_key_ = right_.find_column(spec_.right_column);
+    
+    schema_.table_name = left_.table_name + "_" + right_.table_name;
+    for (auto col : left_.columns) {
+        col.name = left_.table_name + "." + col.name;
+        col.primary_key = false;
+        schema_.columns.push_back(col);
+    }
+    for (auto col : right_.columns) {
+        col.name = right_.table_name + "." + col.name;
+        col.primary_key = false;
+        schema_.columns.push_back(col);
+    }
+}
+
+Status HashJoin::validate() const {
+    if (!left_key_) {
+        return Status::error("Unknown column '" + left_.table_name + "." + spec_.left_column + "'");
+    }
+    if (!right_key_) {
+        return Status::error("Unknown column '" + right_.table_name + "." + spec_.right_column + "'");
+    }
+    
+    DataType lt = left_.columns[*left_key_].type;
+    DataType rt = right_.columns[*right_key_].type;
+    if (lt != rt && !(is_numeric(lt) && is_numeric(rt))) {
+        return Status::error("Cannot join " + spec_.left_column + " with " +
+                             spec_.right_column + ": incompatible types");
+    }
+    
+    return Status::ok();
+}
+
+std::string HashJoin::join_key(const Record& record, bool left) const {
+    DataType type = key_type(left_.columns[*left_key_].type, right_.columns[*right_key_].type);
+    const std::string& raw = record.values[left ? *left_key_ : *right_key_];
+    
+    if (type == DataType::TEXT) {
+        return raw;
+    }
+    return TypedValue::parse(type, raw).to_string();
+}
+
+Record HashJoin::combine(const Record& build, const Record& probe, bool build_is_left) const {
+    const Record& l = build_is_left ? build : probe;
+    const Record& r = build_is_left ? probe : build;
+    
+    Record out;
+    out.values.reserve(l.values.size() + r.values.size());
+    out.values.insert(out.values.end(), l.values.begin(), l.values.end());
+    out.values.insert(out.values.end(), r.values.begin(), r.values.end());
+    return out;
+}
+
+Status HashJoin::run(const BatchSource& left,
+                     const BatchSource& right,
+                     size_t memory_budget,
+                     const std::filesystem::path& spill_dir,
+                     std::unique_ptr<JoinCursor>* cursor,
+                     size_t threads) const {
+    std::unique_ptr<JoinCursor> join(new JoinCursor(*this, memory_budget, threads));
+    const BatchSource* sources[2] = {&left, &right};
+    std::vector<Record> rows[2];
+    size_t bytes[2] = {0, 0};
+    
+    // Read the inputs in turns until one ends or the budget runs out
+    std::vector<Record> batch;
+    std::optional<size_t> ended;
+    for (size_t side = 0; !ended; side = 1 - side) {
+        if (!(*sources[side])(batch)) {
+            ended = side;
+            break;
+        }
+        for (auto& record : batch) {
+            bytes[side] += estimate_record_bytes(record) + kEntryOverhead;
+            rows[side].push_back(std::move(record));
+        }
+        if (memory_budget > 0 && bytes[0] + bytes[1] > memory_budget) {
+            break;
+        }
+    }
+    
+    if (ended) {
+        // Hash the side that ended; the other probes it with the rows
+        // already read, then the rest of its stream. Nothing joins an
+        // empty side.
+        size_t build = *ended;
+        if (rows[build].empty()) {
+            *cursor = std::move(join);
+            return Status::ok();
+        }
+        
+        auto buffered = std::make_shared<std::vector<Record>>(std::move(rows[1 - build]));
+        size_t next = 0;
+        BatchSource rest = *sources[1 - build];
+        join->probe_ = [buffered, next, rest](std::vector<Record>& batch) mutable {
+            if (next >= buffered->size()) {
+                buffered->clear();
+                return rest(batch);
+            }
+            batch.clear();
+            while (next < buffered->size() && batch.size() < TableCursor::kDefaultBatchSize) {
+                batch.push_back(std::move((*buffered)[next++]));
+            }
+            return true;
+        };
+        join->build(std::move(rows[build]), build == 0);
+        *cursor = std::move(join);
+        return Status::ok();
+    }
+    
+    join->spill_dir_ = spill_dir /
+        ("join-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::error_code ec;
+    std::filesystem::create_directories(join->spill_dir_, ec);
+    if (ec) {
+        return Status::error("Failed to create spill directory " + join->spill_dir_.string());
+    }
+    
+    std::vector<JoinCursor::Partition> parts(kSpillPartitions);
+    for (size_t side = 0; side < 2; ++side) {
+        if (!join->spill(rows[side], *sources[side], side, 0, "", parts)) {
+            return Status::error("Failed to spill join input to " + join->spill_dir_.string());
+        }
+    }
+    join->partitions_.assign(parts.rbegin(), parts.rend());
+    
+    *cursor = std::move(join);
+    return Status::ok();
+}
+
+JoinCursor::JoinCursor(const HashJoin& join, size_t memory_budget, size_t threads)
+    : join_(join), memory_budget_(memory_budget), threads_(std::max<size_t>(threads, 1)) {
+}
+
+JoinCursor::~JoinCursor() {
+    probe_ = nullptr;
+    if (!spill_dir_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(spill_dir_, ec);
+    }
+}
+
+bool JoinCursor::next_batch(std::vector<Record>& batch) {
+    batch.clear();
+    
+    // Probe in chunks big enough to split across threads
+    const size_t chunk_rows = threads_ * HashJoin::kMinRowsPerPartition;
+    while (batch.empty()) {
+        if (!probe_ && !next_partition()) {
+            return false;
+        }
+        
+        std::vector<Record> input, chunk;
+        bool more = true;
+        while (input.size() < chunk_rows && (more = probe_(chunk))) {
+            input.insert(input.end(), std::make_move_iterator(chunk.begin()),
+                         std::make_move_iterator(chunk.end()));
+        }
+        
+        probe(input, batch);
+        if (!more) {
+            finish_partition();
+        }
+    }
+    return true;
+}
+
+void JoinCursor::build(std::vector<Record> rows, bool build_is_left) {
+    build_rows_ = std::move(rows);
+    build_is_left_ = build_is_left;
+    
+    table_.clear();
+    table_.reserve(build_rows_.size());
+    for (const Record& record : build_rows_) {
+        table_[join_.join_key(record, build_is_left_)].push_back(&record);
+    }
+}
+
+void JoinCursor::probe(const std::vector<Record>& rows, std::vector<Record>& out) {
+    auto probe_range = [&](size_t begin, size_t end, std::vector<Record>& result) {
+        for (size_t i = begin; i < end; ++i) {
+            auto it = table_.find(join_.join_key(rows[i], !build_is_left_));
+            if (it == table_.end()) continue;
+            
+            for (const Record* match : it->second) {
+                result.push_back(join_.combine(*match, rows[i], build_is_left_));
+            }
+        }
+    };
+    
+    size_t max_parts = std::max<size_t>(rows.size() / HashJoin::kMinRowsPerPartition, 1);
+    auto ranges = partition_range(rows.size(), std::min(threads_, max_parts));
+    
+    if (ranges.size() <= 1) {
+        probe_range(0, rows.size(), out);
+        return;
+    }
+    
+    if (!pool_) {
+        pool_ = std::make_unique<ThreadPool>(threads_);
+    }
+    std::vector<std::vector<Record>> partial(ranges.size());
+    std::vector<std::future<void>> pending;
+    for (size_t p = 0; p < ranges.size(); ++p) {
+        pending.push_back(pool_->submit([&, p]() {
+            probe_range(ranges[p].first, ranges[p].second, partial[p]);
+        }));
+    }
+    for (auto& f : pending) {
+        f.get();
+    }
+    
+    // Concatenate in probe order
+    for (auto& part : partial) {
+        out.insert(out.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    }
+}
+
+void JoinCursor::finish_partition() {
+    probe_ = nullptr;
+    table_.clear();
+    build_rows_.clear();
+    build_rows_.shrink_to_fit();
+    
+    if (!probe_file_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(probe_file_, ec);
+        probe_file_.clear();
+    }
+}
+
+bool JoinCursor::next_partition() {
+    while (!partitions_.empty()) {
+        Partition part = std::move(partitions_.back());
+        partitions_.pop_back();
+        
+        // Build on the smaller side; an empty one joins nothing
+        size_t side = part.bytes[0] <= part.bytes[1] ? 0 : 1;
+        std::error_code ec;
+        if (part.bytes[side] == 0) {
+            std::filesystem::remove(part.files[0], ec);
+            std::filesystem::remove(part.files[1], ec);
+            continue;
+        }
+        
+        if (memory_budget_ > 0 && part.bytes[side] > memory_budget_ &&
+            part.level < HashJoin::kMaxSplitLevels) {
+            if (!split(part)) {
+                status_ = Status::error("Failed to split join partition in " + spill_dir_.string());
+                return false;
+            }
+            continue;
+        }
+        
+        std::vector<Record> rows;
+        {
+            SpillReader reader(part.files[side]);
+            Record record;
+            while (reader.next(record)) {
+                rows.push_back(std::move(record));
+            }
+        }
+        std::filesystem::remove(part.files[side], ec);
+        
+        build(std::move(rows), side == 0);
+        probe_ = read_spill(part.files[1 - side]);
+        probe_file_ = part.files[1 - side];
+        return true;
+    }
+    return false;
+}
+
+bool JoinCursor::split(const Partition& partition) {
+    std::vector<Partition> parts(kSpillPartitions);
+    std::string name = "split" + std::to_string(next_split_++) + "-";
+    
+    for (size_t side = 0; side < 2; ++side) {
+        std::vector<Record> none;
+        if (!spill(none, read_spill(partition.files[side]), side, partition.level + 1, name, parts)) {
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::remove(partition.files[side], ec);
+    }
+    
+    partitions_.insert(partitions_.end(), parts.rbegin(), parts.rend());
+    return true;
+}
+
+bool JoinCursor::spill(std::vector<Record>& rows, const BatchSource& source, size_t side,
+                       size_t level, const std::string& name, std::vector<Partition>& parts) {
+    std::vector<std::unique_ptr<SpillWriter>> writers;
+    for (size_t p = 0; p < parts.size(); ++p) {
+        parts[p].level = level;
+        parts[p].files[side] = spill_dir_ / (name + (side == 0 ? "left-" : "right-") + std::to_string(p));
+        writers.push_back(std::make_unique<SpillWriter>(parts[p].files[side]));
+        if (!writers.back()->is_open()) return false;
+    }
+    
+    auto write = [&](const Record& record) {
+        size_t p = partition_of(join_.join_key(record, side == 0), level);
+        writers[p]->write(record);
+        parts[p].bytes[side] += estimate_record_bytes(record) + kEntryOverhead;
+    };
+    
+    for (const auto& record : rows) {
+        write(record);
+    }
+    rows.clear();
+    rows.shrink_to_fit();
+    
+    std::vector<Record> batch;
+    while (source(batch)) {
+        for (const auto& record : batch) {
+            write(record);
+        }
+    }
+    
+    for (auto& writer : writers) {
+        if (!writer->close()) return false;
+    }
+    return true;
+}
+
+} // namespace vsdb
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "db/database.h"
+#include "util/thread_pool.h"
+
+namespace vsdb {
+
+// Equi-join condition "left.column=right.column"
+struct JoinSpec {
+    std::string left_column;
+    std::string right_column;
+    
+    // Accepts either side order and unqualified column names
+    static std::optional<JoinSpec> parse(const std::string& expr,
+                                         const std::string& left_table,
+                                         const std::string& right_table);
+};
+
+class HashJoin;
+
+// Rows of a HashJoin, produced a batch at a time. Spill files are
+// removed when the cursor is destroyed.
+class JoinCursor {
+public:
+    ~JoinCursor();
+    
+    bool next_batch(std::vector<Record>& batch);
+    
+    // Error that ended the join early, if any. Errors of the input
+    // sources are reported by their own cursors.
+    const Status& status() const { return status_; }
+    
+private:
+    friend class HashJoin;
+    
+    // A pair of spilled partitions still to be joined
+    struct Partition {
+        std::filesystem::path files[2]; // Left, right
+        size_t bytes[2] = {0, 0};       // Estimated in-memory size
+        size_t level = 0;               // Times the rows have been split
+    };
+    
+    JoinCursor(const HashJoin& join, size_t memory_budget, size_t threads);
+    
+    const HashJoin& join_;
+    size_t memory_budget_;
+    size_t threads_;
+    std::unique_ptr<ThreadPool> pool_;
+    Status status_;
+    
+    std::filesystem::path spill_dir_;   // Empty unless the inputs spilled
+    std::vector<Partition> partitions_; // Stack; the back is joined next
+    size_t next_split_ = 0;             // Names the files of each split
+    
+    // Hashed build side of the current partition, and its probe stream
+    std::vector<Record> build_rows_;
+    std::unordered_map<std::string, std::vector<const Record*>> table_;
+    bool build_is_left_ = true;
+    BatchSource probe_;
+    std::filesystem::path probe_file_;  // Removed once probed
+    
+    void build(std::vector<Record> rows, bool build_is_left);
+    void probe(const std::vector<Record>& rows, std::vector<Record>& out);
+    void finish_partition();
+    
+    // Load the next partition, splitting it first while its build side
+    // is over budget; false when none are left or on error
+    bool next_partition();
+    bool split(const Partition& partition);
+    
+    // Hash partition `rows` and then the rest of `source` into one side
+    // of `parts`, named "<name><side>-<partition>"
+    bool spill(std::vector<Record>& rows, const BatchSource& source, size_t side,
+               size_t level, const std::string& name, std::vector<Partition>& parts);
+};
+
+// Build/probe hash join over two streams of rows. Both inputs are read
+// in turns until one of them ends; that smaller side is hashed on its key
+// column and the rest of the other side probes it, in parallel ranges.
+// When the memory budget runs out first, both inputs are hash
+// partitioned into spill files as they are read and joined one partition
+// at a time, building on the smaller side of each. A partition whose
+// build side is still over budget is split again on other bits of the
+// key hash.
+class HashJoin {
+public:
+    static constexpr size_t kDefaultMemoryBudget = 256 * 1024 * 1024;
+    static constexpr size_t kMinRowsPerPartition = 16 * 1024;
+    static constexpr size_t kSpillPartitionBits = 4;
+    static constexpr size_t kMaxSplitLevels = 4; // Deeper partitions are joined over budget
+    
+    HashJoin(const TableSchema& left, const TableSchema& right, JoinSpec spec);
+    
+    // Checks that key columns exist and have comparable types
+    Status validate() const;
+    
+    // Columns named "<table>.<column>"
+    const TableSchema& schema() const { return schema_; }
+    
+    // The sources must stay valid while the cursor is read, and the join
+    // must outlive the cursor. Fails if spilling to disk failed.
+    Status run(const BatchSource& left,
+               const BatchSource& right,
+               size_t memory_budget,
+               const std::filesystem::path& spill_dir,
+               std::unique_ptr<JoinCursor>* cursor,
+               size_t threads = ThreadPool::default_threads()) const;
+    
+private:
+    friend class JoinCursor;
+    
+    const TableSchema& left_;
+    const TableSchema& right_;
+    JoinSpec spec_;
+    TableSchema schema_;
+    std::optional<size_t> left_key_;
+    std::optional<size_t> right_key_;
+    
+    std::string join_key(const Record& record, bool left) const;
+    Record combine(const Record& build, const Record& probe, bool build_is_left) const;
+};
+
+} // namespace vsdb
@@ -0,0 +1,112 @@
+#include "query/result_cache.h"
+#include "util/atomic_file.h"
+#include "util/byte_codec.h"
+#include "util/metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace vsdb {
+
+ResultCache::ResultCache(const std::filesystem::path& dir, uintmax_t max_bytes)
+    : dir_(dir), max_bytes_(max_bytes) {
+}
+
+std::filesystem::path ResultCache::entry_path(const std::string& key) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx",
+                  static_cast<unsigned long long>(fnv1a_checksum(key.data(), key.size())));
+    return dir_ / name;
+}
+
+std::optional<std::string> ResultCache::get(const std::string& key) {
+    auto path = entry_path(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        Metrics::instance().add(Counter::CACHE_MISSES);
+        return std::nullopt;
+    }
+    
+    // Entry: key length, key, then the result; a different key means a
+    // hash collision and counts as a miss
+    uint32_t key_size = 0;
+    file.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
+    std::string stored_key(key_size, '\0');
+    file.read(stored_key.data(), key_size);
+    if (!file || stored_key != key) {
+        Metrics::instance().add(Counter::CACHE_MISSES);
+        return std::nullopt;
+    }
+    
+    std::stringstream result;
+    result << file.rdbuf();
+    
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    
+    Metrics::instance().add(Counter::CACHE_HITS);
+    return result.str();
+}
+
+bool ResultCache::put(const std::string& key, const std::string& result) {
+    if (key.size() + result.size() > max_bytes_) {
+        return false;
+    }
+    
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    if (ec) return false;
+    
+    bool written = replace_file(entry_path(key), [&](const std::filesystem::path& tmp) {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        
+        uint32_t key_size = static_cast<uint32_t>(key.size());
+        file.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+        file.write(key.data(), key.size());
+        file.write(result.data(), result.size());
+        return static_cast<bool>(file.flush());
+    });
+    
+    if (written) {
+        evict();
+    }
+    return written;
+}
+
+void ResultCache::evict() {
+    struct Entry {
+        std::filesystem::path path;
+        std::filesystem::file_time_type used;
+        uintmax_t bytes;
+    };
+    
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(dir_, ec)) {
+        if (!file.is_regular_file() || file.path().extension() == ".tmp") continue;
+        
+        Entry entry{file.path(), file.last_write_time(ec), file.file_size(ec)};
+        if (ec) continue;
+        total += entry.bytes;
+        entries.push_back(std::move(entry));
+    }
+    
+    if (total <= max_bytes_) return;
+    
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    
+    for (const auto& entry : entries) {
+        if (total <= max_bytes_) break;
+        if (std::filesystem::remove(entry.path, ec)) {
+            total -= entry.bytes;
+            Metrics::instance().add(Counter::CACHE_EVICTIONS);
+        }
+    }
+}
+
+} // namespace vsdb
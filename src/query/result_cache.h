@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace vsdb {
+
+// Persistent cache of query results over committed, immutable data.
+// Each entry is a file named by a hash of its key and holds the key and
+// the result; the file's modification time records its last use, so
+// every process sharing the directory sees the same LRU order. Once
+// the entries exceed the budget the least recently used are removed.
+class ResultCache {
+public:
+    static constexpr uintmax_t kDefaultMaxBytes = 64 * 1024 * 1024;
+    
+    explicit ResultCache(const std::filesystem::path& dir, uintmax_t max_bytes = kDefaultMaxBytes);
+    
+    uintmax_t max_bytes() const { return max_bytes_; }
+    
+    // Cached result for a key; a hit marks the entry as recently used
+    std::optional<std::string> get(const std::string& key);
+    
+    // Store a result, then evict down to the budget. Results larger than
+    // the whole budget are not stored.
+    bool put(const std::string& key, const std::string& result);
+    
+private:
+    std::filesystem::path dir_;
+    uintmax_t max_bytes_;
+    
+    std::filesystem::path entry_path(const std::string& key) const;
+    void evict();
+};
+
+} // namespace vsdb
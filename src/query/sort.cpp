@@ -0,0 +1,235 @@
+#include "query/sort.h"
+#include "query/spill_file.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <queue>
+
+namespace vsdb {
+
+Sorter::Sorter(const TableSchema& schema, SortSpec spec)
+    : schema_(schema), spec_(std::move(spec)) {
+    column_ = schema_.find_column(spec_.column);
+}
+
+Status Sorter::validate() const {
+    if (!column_) {
+        return Status::error("Unknown column '" + spec_.column + "'");
+    }
+    return Status::ok();
+}
+
+Sorter::Item Sorter::make_item(Record record, size_t seq) const {
+    Item item;
+    item.key = TypedValue::parse(schema_.columns[*column_].type, record.values[*column_]);
+    item.seq = seq;
+    item.record = std::move(record);
+    return item;
+}
+
+// Strict ordering; equal keys keep their input order
+bool Sorter::before(const Item& a, const Item& b) const {
+    int cmp = a.key.compare(b.key);
+    if (cmp != 0) {
+        return spec_.descending ? cmp > 0 : cmp < 0;
+    }
+    return a.seq < b.seq;
+}
+
+void Sorter::top_k(const RowSource& source, const RowSink& sink, size_t k) const {
+    if (k == 0) return;
+    
+    // Max-heap on output order: the top is the worst row kept so far
+    auto cmp = [this](const Item& a, const Item& b) { return before(a, b); };
+    std::priority_queue<Item, std::vector<Item>, decltype(cmp)> heap(cmp);
+    
+    Record record;
+    size_t seq = 0;
+    while (source(record)) {
+        Item item = make_item(std::move(record), seq++);
+        
+        if (heap.size() < k) {
+            heap.push(std::move(item));
+        } else if (before(item, heap.top())) {
+            heap.pop();
+            heap.push(std::move(item));
+        }
+    }
+    
+    std::vector<Item> best;
+    best.reserve(heap.size());
+    while (!heap.empty()) {
+        best.push_back(std::move(const_cast<Item&>(heap.top())));
+        heap.pop();
+    }
+    
+    for (auto it = best.rbegin(); it != best.rend(); ++it) {
+        sink(it->record);
+    }
+}
+
+void Sorter::sort_in_memory(std::vector<Item>& items, size_t threads) const {
+    auto cmp = [this](const Item& a, const Item& b) { return before(a, b); };
+    
+    size_t max_chunks = std::max<size_t>(items.size() / kMinRowsPerChunk, 1);
+    auto ranges = partition_range(items.size(), std::min(threads, max_chunks));
+    
+    if (ranges.size() <= 1) {
+        std::sort(items.begin(), items.end(), cmp);
+        return;
+    }
+    
+    ThreadPool pool(ranges.size());
+    
+    // Sort chunks independently
+    {
+        std::vector<std::future<void>> pending;
+        for (const auto& [begin, end] : ranges) {
+            pending.push_back(pool.submit([&, begin = begin, end = end]() {
+                std::sort(items.begin() + begin, items.begin() + end, cmp);
+            }));
+        }
+        for (auto& f : pending) f.get();
+    }
+    
+    // Merge neighbouring chunks pairwise until one remains
+    while (ranges.size() > 1) {
+        std::vector<std::pair<size_t, size_t>> merged;
+        std::vector<std::future<void>> pending;
+        
+        for (size_t i = 0; i + 1 < ranges.size(); i += 2) {
+            size_t begin = ranges[i].first;
+            size_t mid = ranges[i].second;
+            size_t end = ranges[i + 1].second;
+            
+            pending.push_back(pool.submit([&, begin, mid, end]() {
+                std::inplace_merge(items.begin() + begin, items.begin() + mid, items.begin() + end, cmp);
+            }));
+            merged.emplace_back(begin, end);
+        }
+        if (ranges.size() % 2 == 1) {
+            merged.push_back(ranges.back());
+        }
+        
+        for (auto& f : pending) f.get();
+        ranges = std::move(merged);
+    }
+}
+
+bool Sorter::merge_runs(const std::vector<std::filesystem::path>& runs, const RowSink& sink) const {
+    struct Head {
+        Item item;
+        size_t run;
+    };
+    
+    // Min-heap on output order; ties resolved by run order for stability
+    auto cmp = [this](const Head& a, const Head& b) {
+        int c = a.item.key.compare(b.item.key);
+        if (c != 0) return spec_.descending ? c < 0 : c > 0;
+        return a.run > b.run;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(cmp)> heap(cmp);
+    
+    std::vector<std::unique_ptr<SpillReader>> readers;
+    for (size_t r = 0; r < runs.size(); ++r) {
+        readers.push_back(std::make_unique<SpillReader>(runs[r]));
+        if (!readers.back()->is_open()) return false;
+        
+        Record record;
+        if (readers[r]->next(record)) {
+            heap.push({make_item(std::move(record), 0), r});
+        }
+    }
+    
+    while (!heap.empty()) {
+        Head head = std::move(const_cast<Head&>(heap.top()));
+        heap.pop();
+        
+        sink(head.item.record);
+        
+        Record record;
+        if (readers[head.run]->next(record)) {
+            heap.push({make_item(std::move(record), 0), head.run});
+        }
+    }
+    
+    return true;
+}
+
+Status Sorter::run(const RowSource& source,
+                   const RowSink& sink,
+                   size_t memory_budget,
+                   const std::filesystem::path& spill_dir,
+                   size_t threads) const {
+    if (spec_.limit) {
+        top_k(source, sink, *spec_.limit);
+        return Status::ok();
+    }
+    
+    std::filesystem::path dir;
+    std::vector<std::filesystem::path> runs;
+    std::vector<Item> buffer;
+    size_t buffered_bytes = 0;
+    size_t seq = 0;
+    bool ok = true;
+    
+    // Sort the buffer and write it out as one run
+    auto spill = [&]() {
+        if (dir.empty()) {
+            dir = spill_dir /
+                ("sort-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+            std::error_code ec;
+            std::filesystem::create_directories(dir, ec);
+            if (ec) return false;
+        }
+        
+        sort_in_memory(buffer, threads);
+        
+        runs.push_back(dir / ("run-" + std::to_string(runs.size())));
+        SpillWriter writer(runs.back());
+        if (!writer.is_open()) return false;
+        
+        for (const auto& item : buffer) {
+            writer.write(item.record);
+        }
+        
+        buffer.clear();
+        buffered_bytes = 0;
+        return writer.close();
+    };
+    
+    Record record;
+    while (ok && source(record)) {
+        buffered_bytes += estimate_record_bytes(record) + sizeof(Item);
+        buffer.push_back(make_item(std::move(record), seq++));
+        
+        if (memory_budget > 0 && buffered_bytes > memory_budget) {
+            ok = spill();
+        }
+    }
+    
+    if (ok && runs.empty()) {
+        sort_in_memory(buffer, threads);
+        for (const auto& item : buffer) {
+            sink(item.record);
+        }
+        return Status::ok();
+    }
+    
+    if (ok && !buffer.empty()) {
+        ok = spill();
+    }
+    if (ok) {
+        ok = merge_runs(runs, sink);
+    }
+    
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    
+    if (!ok) {
+        return Status::error("Failed to spill sort runs to " + spill_dir.string());
+    }
+    return Status::ok();
+}
+
+} // namespace vsdb
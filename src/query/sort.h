@@ -0,0 +1,65 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include "db/database.h"
+#include "util/thread_pool.h"
+
+namespace vsdb {
+
+struct SortSpec {
+    std::string column;
+    bool descending = false;
+    std::optional<size_t> limit;
+};
+
+// Produces the next input row; returns false when exhausted
+using RowSource = std::function<bool(Record&)>;
+// Receives output rows in order
+using RowSink = std::function<void(const Record&)>;
+
+// Stable ORDER BY over a stream of rows.
+//  - With a limit, keeps only the best k rows in a bounded heap.
+//  - Otherwise buffers rows and sorts them in parallel chunks that are
+//    merged, as long as the buffer stays within the memory budget.
+//  - Past the budget, sorted runs are spilled to disk and combined with
+//    a k-way merge.
+class Sorter {
+public:
+    static constexpr size_t kDefaultMemoryBudget = 256 * 1024 * 1024;
+    static constexpr size_t kMinRowsPerChunk = 16 * 1024;
+    
+    Sorter(const TableSchema& schema, SortSpec spec);
+    
+    Status validate() const;
+    
+    // Fails if spilling to disk failed
+    Status run(const RowSource& source,
+               const RowSink& sink,
+               size_t memory_budget,
+               const std::filesystem::path& spill_dir,
+               size_t threads = ThreadPool::default_threads()) const;
+    
+private:
+    struct Item {
+        TypedValue key;
+        size_t seq;
+        Record record;
+    };
+    
+    const TableSchema& schema_;
+    SortSpec spec_;
+    std::optional<size_t> column_;
+    
+    Item make_item(Record record, size_t seq) const;
+    bool before(const Item& a, const Item& b) const;
+    
+    void top_k(const RowSource& source, const RowSink& sink, size_t k) const;
+    void sort_in_memory(std::vector<Item>& items, size_t threads) const;
+    bool merge_runs(const std::vector<std::filesystem::path>& runs, const RowSink& sink) const;
+};
+
+} // namespace vsdb
@@ -0,0 +1,63 @@
+#include "query/spill_file.h"
+#include "util/metrics.h"
+
+namespace vsdb {
+
+SpillWriter::SpillWriter(const std::filesystem::path& path)
+    : file_(path, std::ios::binary | std::ios::trunc) {
+}
+
+void SpillWriter::write(const Record& record) {
+    uint32_t count = static_cast<uint32_t>(record.values.size());
+    file_.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    bytes_written_ += sizeof(count);
+    
+    for (const auto& value : record.values) {
+        uint32_t len = static_cast<uint32_t>(value.size());
+        file_.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        file_.write(value.data(), len);
+        bytes_written_ += sizeof(len) + len;
+    }
+}
+
+bool SpillWriter::close() {
+    file_.close();
+    Metrics::instance().add(Counter::BYTES_WRITTEN, bytes_written_);
+    return !file_.fail();
+}
+
+SpillReader::SpillReader(const std::filesystem::path& path)
+    : file_(path, std::ios::binary) {
+}
+
+bool SpillReader::next(Record& record) {
+    uint32_t count;
+    if (!file_.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        return false;
+    }
+    
+    uint64_t bytes = sizeof(count);
+    record.values.resize(count);
+    for (auto& value : record.values) {
+        uint32_t len;
+        if (!file_.read(reinterpret_cast<char*>(&len), sizeof(len))) {
+            return false;
+        }
+        value.resize(len);
+        file_.read(value.data(), len);
+        bytes += sizeof(len) + len;
+    }
+    
+    Metrics::instance().add(Counter::BYTES_READ, bytes);
+    return static_cast<bool>(file_);
+}
+
+size_t estimate_record_bytes(const Record& record) {
+    size_t bytes = sizeof(Record);
+    for (const auto& value : record.values) {
+        bytes += sizeof(std::string) + value.size();
+    }
+    return bytes;
+}
+
+} // namespace vsdb
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include "db/database.h"
+
+namespace vsdb {
+
+// Length-prefixed binary record files used when an operator spills
+// intermediate rows to disk.
+class SpillWriter {
+public:
+    explicit SpillWriter(const std::filesystem::path& path);
+    
+    bool is_open() const { return file_.is_open(); }
+    void write(const Record& record);
+    bool close();
+    
+    uint64_t bytes_written() const { return bytes_written_; }
+    
+private:
+    std::ofstream file_;
+    uint64_t bytes_written_ = 0;
+};
+
+class SpillReader {
+public:
+    explicit SpillReader(const std::filesystem::path& path);
+    
+    bool is_open() const { return file_.is_open(); }
+    
+    // Read the next record; false at end of file
+    bool next(Record& record);
+    
+private:
+    std::ifstream file_;
+};
+
+// Rough in-memory footprint of a record, used against memory budgets
+size_t estimate_record_bytes(const Record& record);
+
+} // namespace vsdb
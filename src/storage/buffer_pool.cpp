@@ -0,0 +1,164 @@
+#include "storage/buffer_pool.h"
+#include "util/metrics.h"
+#include <algorithm>
+#include <cstring>
+
+namespace vsdb {
+
+// PageFile Implementation
+PageFile::PageFile(const std::filesystem::path& path) {
+    if (!std::filesystem::exists(path)) {
+        std::ofstream create(path, std::ios::binary);
+    }
+    
+    file_.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (file_.is_open()) {
+        page_count_ = static_cast<PageId>(std::filesystem::file_size(path) / kPageSize);
+    }
+}
+
+bool PageFile::read_page(PageId id, char* data) {
+    if (id >= page_count_) return false;
+    
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(id) * kPageSize);
+    file_.read(data, kPageSize);
+    
+    Metrics::instance().add(Counter::BYTES_READ, kPageSize);
+    Metrics::instance().add(Counter::PAGES_READ);
+    return static_cast<bool>(file_);
+}
+
+bool PageFile::write_page(PageId id, const char* data) {
+    file_.clear();
+    file_.seekp(static_cast<std::streamoff>(id) * kPageSize);
+    file_.write(data, kPageSize);
+    
+    Metrics::instance().add(Counter::BYTES_WRITTEN, kPageSize);
+    Metrics::instance().add(Counter::PAGES_WRITTEN);
+    return static_cast<bool>(file_);
+}
+
+PageId PageFile::allocate_page() {
+    return page_count_++;
+}
+
+bool PageFile::sync() {
+    file_.flush();
+    return static_cast<bool>(file_);
+}
+
+// BufferPool Implementation
+BufferPool::BufferPool(PageFile& file, size_t frames)
+    : file_(file), frames_(std::max<size_t>(frames, 1)) {
+    for (auto& frame : frames_) {
+        frame.data = std::make_unique<char[]>(kPageSize);
+    }
+}
+
+std::optional<size_t> BufferPool::acquire_frame() {
+    // Two full sweeps clear every reference bit once
+    for (size_t step = 0; step < 2 * frames_.size(); ++step) {
+        size_t index = clock_hand_;
+        clock_hand_ = (clock_hand_ + 1) % frames_.size();
+        Frame& frame = frames_[index];
+        
+        if (!frame.in_use) {
+            return index;
+        }
+        if (frame.pin_count > 0) {
+            continue;
+        }
+        if (frame.referenced) {
+            frame.referenced = false;
+            continue;
+        }
+        
+        if (frame.dirty && !file_.write_page(frame.page_id, frame.data.get())) {
+            return std::nullopt;
+        }
+        
+        page_table_.erase(frame.page_id);
+        frame.in_use = false;
+        frame.dirty = false;
+        Metrics::instance().add(Counter::PAGES_EVICTED);
+        return index;
+    }
+    
+    return std::nullopt;
+}
+
+char* BufferPool::pin(PageId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = page_table_.find(id);
+    if (it != page_table_.end()) {
+        Frame& frame = frames_[it->second];
+        frame.pin_count++;
+        frame.referenced = true;
+        return frame.data.get();
+    }
+    
+    auto index = acquire_frame();
+    if (!index) return nullptr;
+    
+    Frame& frame = frames_[*index];
+    if (!file_.read_page(id, frame.data.get())) {
+        return nullptr;
+    }
+    
+    frame.page_id = id;
+    frame.in_use = true;
+    frame.dirty = false;
+    frame.referenced = true;
+    frame.pin_count = 1;
+    page_table_[id] = *index;
+    return frame.data.get();
+}
+
+void BufferPool::unpin(PageId id, bool dirty) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = page_table_.find(id);
+    if (it == page_table_.end()) return;
+    
+    Frame& frame = frames_[it->second];
+    if (frame.pin_count > 0) frame.pin_count--;
+    frame.dirty = frame.dirty || dirty;
+}
+
+char* BufferPool::new_page(PageId& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto index = acquire_frame();
+    if (!index) return nullptr;
+    
+    id = file_.allocate_page();
+    
+    Frame& frame = frames_[*index];
+    std::memset(frame.data.get(), 0, kPageSize);
+    frame.page_id = id;
+    frame.in_use = true;
+    frame.dirty = true;
+    frame.referenced = true;
+    frame.pin_count = 1;
+    page_table_[id] = *index;
+    return frame.data.get();
+}
+
+bool BufferPool::flush_all() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    for (auto& frame : frames_) {
+        if (frame.in_use && frame.dirty) {
+            if (!file_.write_page(frame.page_id, frame.data.get())) {
+                return false;
+            }
+            frame.dirty = false;
+        }
+    }
+    
+    return file_.sync();
+}
+
+} // namespace vsdb
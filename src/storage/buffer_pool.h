@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace vsdb {
+
+constexpr size_t kPageSize = 8192;
+
+using PageId = uint32_t;
+
+// Fixed-size pages stored back to back in one file
+class PageFile {
+public:
+    explicit PageFile(const std::filesystem::path& path);
+    
+    bool is_open() const { return file_.is_open(); }
+    PageId page_count() const { return page_count_; }
+    
+    bool read_page(PageId id, char* data);
+    bool write_page(PageId id, const char* data);
+    PageId allocate_page();
+    bool sync();
+    
+private:
+    std::fstream file_;
+    PageId page_count_ = 0;
+};
+
+// Caches pages of a PageFile in a fixed number of frames. Pinned pages
+// are never evicted; unpinned ones are replaced with the CLOCK
+// (second-chance) policy and written back only if dirty.
+class BufferPool {
+public:
+    static constexpr size_t kDefaultFrames = 1024;
+    
+    BufferPool(PageFile& file, size_t frames = kDefaultFrames);
+    
+    // Page data stays valid until the matching unpin; nullptr if every
+    // frame is pinned or the read fails
+    char* pin(PageId id);
+    void unpin(PageId id, bool dirty);
+    
+    // Append a zeroed page to the file and pin it
+    char* new_page(PageId& id);
+    
+    bool flush_all();
+    
+private:
+    struct Frame {
+        PageId page_id = 0;
+        bool in_use = false;
+        bool dirty = false;
+        bool referenced = false;
+        uint32_t pin_count = 0;
+        std::unique_ptr<char[]> data;
+    };
+    
+    PageFile& file_;
+    std::vector<Frame> frames_;
+    std::unordered_map<PageId, size_t> page_table_;
+    size_t clock_hand_ = 0;
+    std::mutex mutex_;
+    
+    // Find a free or evictable frame; must hold mutex_
+    std::optional<size_t> acquire_frame();
+};
+
+// Pins a page for the lifetime of the guard
+class PageGuard {
+public:
+    PageGuard(BufferPool& pool, PageId id) : pool_(pool), id_(id), data_(pool.pin(id)) {}
+    ~PageGuard() { if (data_) pool_.unpin(id_, dirty_); }
+    
+    PageGuard(const PageGuard&) = delete;
+    PageGuard& operator=(const PageGuard&) = delete;
+    
+    char* data() const { return data_; }
+    void mark_dirty() { dirty_ = true; }
+    explicit operator bool() const { return data_ != nullptr; }
+    
+private:
+    BufferPool& pool_;
+    PageId id_;
+    char* data_;
+    bool dirty_ = false;
+};
+
+} // namespace vsdb
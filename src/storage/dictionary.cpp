@@ -0,0 +1,25 @@
+#include "storage/dictionary.h"
+
+namespace vsdb {
+
+uint32_t DictionaryColumn::encode(const std::string& value) {
+    auto [it, inserted] = lookup_.try_emplace(value, static_cast<uint32_t>(values_.size()));
+    if (inserted) {
+        values_.push_back(value);
+    }
+    return it->second;
+}
+
+std::optional<uint32_t> DictionaryColumn::find(const std::string& value) const {
+    auto it = lookup_.find(value);
+    if (it == lookup_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+bool DictionaryColumn::worth_encoding(size_t rows, size_t distinct) {
+    return rows >= kMinRows && distinct <= rows * kMaxDistinctRatio;
+}
+
+} // namespace vsdb
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vsdb {
+
+// Dictionary-encoded view of one TEXT column: every distinct value gets
+// a dense integer code and each row stores only its code.
+class DictionaryColumn {
+public:
+    // Encode only when at most this fraction of values are distinct
+    static constexpr double kMaxDistinctRatio = 0.5;
+    static constexpr size_t kMinRows = 16;
+    // Rows probed before building a dictionary for a new column
+    static constexpr size_t kSampleRows = 4096;
+    
+    // Code of a value, adding it to the dictionary if new
+    uint32_t encode(const std::string& value);
+    std::optional<uint32_t> find(const std::string& value) const;
+    const std::string& decode(uint32_t code) const { return values_[code]; }
+    
+    void append(const std::string& value) { codes_.push_back(encode(value)); }
+    void reserve(size_t rows) { codes_.reserve(rows); }
+    void append_code(uint32_t code) { codes_.push_back(code); }
+    uint32_t code_at(size_t row_id) const { return codes_[row_id]; }
+    
+    size_t distinct() const { return values_.size(); }
+    size_t rows() const { return codes_.size(); }
+    const std::vector<std::string>& values() const { return values_; }
+    
+    // Whether a column with these statistics is worth encoding
+    static bool worth_encoding(size_t rows, size_t distinct);
+    
+private:
+    std::vector<std::string> values_;
+    std::unordered_map<std::string, uint32_t> lookup_;
+    std::vector<uint32_t> codes_;
+};
+
+} // namespace vsdb
@@ -0,0 +1,319 @@
+#include "storage/paged_store.h"
+#include "util/atomic_file.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace vsdb {
+
+namespace {
+
+constexpr char kDirMagic[8] = {'V', 'S', 'D', 'B', 'P', 'D', 'I', 'R'};
+constexpr uint32_t kDirVersion = 1;
+constexpr size_t kDirHeaderSize = 32;
+
+constexpr size_t kPageHeaderSize = 8;
+constexpr size_t kSlotSize = 4;
+
+uint16_t read_u16(const char* p) {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+void write_u16(char* p, uint16_t v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// Page header: slot count, then offset of the lowest record byte
+uint16_t slot_count(const char* page) { return read_u16(page); }
+uint16_t free_end(const char* page) {
+    uint16_t end = read_u16(page + 2);
+    return end == 0 ? static_cast<uint16_t>(kPageSize) : end;
+}
+
+// Value count, then (length, bytes) per value
+std::string encode_row(const std::vector<std::string>& values) {
+    std::string out;
+    char buf[2];
+    
+    write_u16(buf, static_cast<uint16_t>(values.size()));
+    out.append(buf, 2);
+    for (const auto& value : values) {
+        write_u16(buf, static_cast<uint16_t>(value.size()));
+        out.append(buf, 2);
+        out.append(value);
+    }
+    return out;
+}
+
+bool decode_row(const char* data, size_t length, std::vector<std::string>& values) {
+    if (length < 2) return false;
+    
+    uint16_t count = read_u16(data);
+    size_t pos = 2;
+    values.resize(count);
+    
+    for (auto& value : values) {
+        if (pos + 2 > length) return false;
+        uint16_t len = read_u16(data + pos);
+        pos += 2;
+        if (pos + len > length) return false;
+        value.assign(data + pos, len);
+        pos += len;
+    }
+    return true;
+}
+
+} // namespace
+
+PagedStore::PagedStore(const std::filesystem::path& pages_path, const std::filesystem::path& dir_path,
+                       size_t pool_frames)
+    : dir_path_(dir_path), file_(pages_path), pool_(file_, pool_frames) {
+}
+
+std::unique_ptr<PagedStore> PagedStore::open(const std::filesystem::path& pages_path,
+                                             const std::filesystem::path& dir_path,
+                                             size_t pool_frames) {
+    std::unique_ptr<PagedStore> store(new PagedStore(pages_path, dir_path, pool_frames));
+    
+    if (!store->file_.is_open() || !store->load_directory()) {
+        return nullptr;
+    }
+    return store;
+}
+
+size_t PagedStore::max_row_bytes() {
+    return kPageSize - kPageHeaderSize - kSlotSize;
+}
+
+bool PagedStore::load_directory() {
+    if (std::filesystem::exists(dir_path_)) {
+        std::ifstream file(dir_path_, std::ios::binary);
+        char header[kDirHeaderSize];
+        if (!file.read(header, kDirHeaderSize) || std::memcmp(header, kDirMagic, sizeof(kDirMagic)) != 0) {
+            return false;
+        }
+        
+        uint32_t version, page_size;
+        uint64_t page_count, row_count;
+        std::memcpy(&version, header + 8, 4);
+        std::memcpy(&page_size, header + 12, 4);
+        std::memcpy(&page_count, header + 16, 8);
+        std::memcpy(&row_count, header + 24, 8);
+        
+        if (version != kDirVersion || page_size != kPageSize || page_count > file_.page_count()) {
+            return false;
+        }
+        
+        slot_counts_.resize(page_count);
+        file.read(reinterpret_cast<char*>(slot_counts_.data()), page_count * sizeof(uint32_t));
+        if (!file) {
+            return false;
+        }
+        
+        size_t rows = 0;
+        for (uint32_t count : slot_counts_) {
+            rows += count;
+        }
+        if (rows != row_count) {
+            return false;
+        }
+    }
+    
+    // Pages written after the directory was last flushed, or every page if
+    // it is missing: their counts are read from the page headers, so new
+    // pages keep the ids the directory gives them
+    dir_dirty_from_ = slot_counts_.size();
+    for (PageId p = static_cast<PageId>(slot_counts_.size()); p < file_.page_count(); ++p) {
+        PageGuard page(pool_, p);
+        if (!page) return false;
+        slot_counts_.push_back(slot_count(page.data()));
+    }
+    
+    first_rows_.resize(slot_counts_.size());
+    size_t rows = 0;
+    for (size_t p = 0; p < slot_counts_.size(); ++p) {
+        first_rows_[p] = rows;
+        rows += slot_counts_[p];
+    }
+    row_count_ = rows;
+    return true;
+}
+
+bool PagedStore::append(const std::vector<std::string>& values) {
+    std::string row = encode_row(values);
+    if (row.size() > max_row_bytes()) {
+        return false;
+    }
+    
+    const size_t needed = row.size() + kSlotSize;
+    
+    if (!slot_counts_.empty()) {
+        PageId last = static_cast<PageId>(slot_counts_.size() - 1);
+        PageGuard page(pool_, last);
+        if (!page) return false;
+        
+        char* data = page.data();
+        uint16_t slots = slot_count(data);
+        uint16_t end = free_end(data);
+        size_t free = end - (kPageHeaderSize + slots * kSlotSize);
+        
+        if (free >= needed) {
+            uint16_t offset = static_cast<uint16_t>(end - row.size());
+            std::memcpy(data + offset, row.data(), row.size());
+            write_u16(data + kPageHeaderSize + slots * kSlotSize, offset);
+            write_u16(data + kPageHeaderSize + slots * kSlotSize + 2, static_cast<uint16_t>(row.size()));
+            write_u16(data, slots + 1);
+            write_u16(data + 2, offset);
+            page.mark_dirty();
+            
+            slot_counts_[last]++;
+            row_count_++;
+            dir_dirty_from_ = std::min<size_t>(dir_dirty_from_, last);
+            return true;
+        }
+    }
+    
+    // Start a new page
+    PageId id;
+    char* data = pool_.new_page(id);
+    if (!data) return false;
+    
+    uint16_t offset = static_cast<uint16_t>(kPageSize - row.size());
+    std::memcpy(data + offset, row.data(), row.size());
+    write_u16(data + kPageHeaderSize, offset);
+    write_u16(data + kPageHeaderSize + 2, static_cast<uint16_t>(row.size()));
+    write_u16(data, 1);
+    write_u16(data + 2, offset);
+    pool_.unpin(id, true);
+    
+    slot_counts_.push_back(1);
+    first_rows_.push_back(row_count_);
+    row_count_++;
+    dir_dirty_from_ = std::min<size_t>(dir_dirty_from_, id);
+    return true;
+}
+
+size_t PagedStore::page_of_row(size_t row_id) {
+    size_t last = last_page_.load(std::memory_order_relaxed);
+    if (last < first_rows_.size() &&
+        row_id >= first_rows_[last] &&
+        row_id < first_rows_[last] + slot_counts_[last]) {
+        return last;
+    }
+    
+    auto it = std::upper_bound(first_rows_.begin(), first_rows_.end(), row_id);
+    last = static_cast<size_t>(it - first_rows_.begin()) - 1;
+    last_page_.store(last, std::memory_order_relaxed);
+    return last;
+}
+
+bool PagedStore::read_row(size_t row_id, std::vector<std::string>& values) {
+    if (row_id >= row_count_) return false;
+    
+    size_t page_index = page_of_row(row_id);
+    size_t slot = row_id - first_rows_[page_index];
+    
+    PageGuard page(pool_, static_cast<PageId>(page_index));
+    if (!page) return false;
+    
+    const char* data = page.data();
+    uint16_t offset = read_u16(data + kPageHeaderSize + slot * kSlotSize);
+    uint16_t length = read_u16(data + kPageHeaderSize + slot * kSlotSize + 2);
+    if (offset + length > kPageSize) return false;
+    
+    return decode_row(data + offset, length, values);
+}
+
+bool PagedStore::flush() {
+    if (!pool_.flush_all()) {
+        return false;
+    }
+    
+    if (!std::filesystem::exists(dir_path_)) {
+        std::ofstream create(dir_path_, std::ios::binary);
+        dir_dirty_from_ = 0;
+    }
+    
+    std::fstream file(dir_path_, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) return false;
+    
+    char header[kDirHeaderSize] = {};
+    uint32_t version = kDirVersion;
+    uint32_t page_size = kPageSize;
+    uint64_t page_count = slot_counts_.size();
+    uint64_t row_count = row_count_;
+    std::memcpy(header, kDirMagic, sizeof(kDirMagic));
+    std::memcpy(header + 8, &version, 4);
+    std::memcpy(header + 12, &page_size, 4);
+    std::memcpy(header + 16, &page_count, 8);
+    std::memcpy(header + 24, &row_count, 8);
+    file.write(header, kDirHeaderSize);
+    
+    // Only entries from the last touched page onwards can have changed
+    if (dir_dirty_from_ < slot_counts_.size()) {
+        file.seekp(kDirHeaderSize + dir_dirty_from_ * sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(slot_counts_.data() + dir_dirty_from_),
+                   (slot_counts_.size() - dir_dirty_from_) * sizeof(uint32_t));
+    }
+    dir_dirty_from_ = slot_counts_.size();
+    
+    return static_cast<bool>(file);
+}
+
+bool PagedStore::read_mutable_parts(const std::filesystem::path& path, bool directory,
+                                    MutableParts* parts) {
+    std::error_code ec;
+    parts->size = std::filesystem::file_size(path, ec);
+    parts->ranges.clear();
+    if (ec) return false;
+    
+    // flush() rewrites the directory header and the entries from the last
+    // page on; the buffer pool only ever writes the last page and new ones
+    std::vector<std::pair<uint64_t, uint64_t>> spans;
+    if (directory) {
+        spans.emplace_back(0, std::min<uint64_t>(kDirHeaderSize, parts->size));
+        if (parts->size >= kDirHeaderSize + sizeof(uint32_t)) {
+            spans.emplace_back(parts->size - sizeof(uint32_t), sizeof(uint32_t));
+        }
+    } else if (parts->size >= kPageSize) {
+        uint64_t last = parts->size / kPageSize * kPageSize - kPageSize;
+        spans.emplace_back(last, parts->size - last);
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    for (const auto& [offset, length] : spans) {
+        std::string bytes(length, '\0');
+        file.seekg(static_cast<std::streamoff>(offset));
+        if (!file.read(bytes.data(), static_cast<std::streamsize>(length))) return false;
+        parts->ranges.emplace_back(offset, std::move(bytes));
+    }
+    return true;
+}
+
+bool PagedStore::freeze_copy(const std::filesystem::path& link, const MutableParts& parts) {
+    return replace_file(link, [&](const std::filesystem::path& tmp_path) {
+        std::ifstream in(link, std::ios::binary);
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!in.is_open() || !out.is_open()) return false;
+        
+        std::vector<char> buffer(256 * kPageSize);
+        uint64_t remaining = parts.size;
+        while (remaining > 0) {
+            auto chunk = static_cast<std::streamsize>(std::min<uint64_t>(remaining, buffer.size()));
+            if (!in.read(buffer.data(), chunk)) return false;
+            out.write(buffer.data(), chunk);
+            remaining -= static_cast<uint64_t>(chunk);
+        }
+        
+        for (const auto& [offset, bytes] : parts.ranges) {
+            out.seekp(static_cast<std::streamoff>(offset));
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        return static_cast<bool>(out.flush());
+    });
+}
+
+} // namespace vsdb
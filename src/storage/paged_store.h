@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "storage/buffer_pool.h"
+
+namespace vsdb {
+
+// Row storage in slotted pages, accessed through a buffer pool.
+//
+// <table>.pages holds the data pages. Each page starts with an 8-byte
+// header (slot count, start of the record area), followed by a slot
+// array of (offset, length) pairs; records are packed from the end of
+// the page towards the slots. Rows are appended in order, so the rows
+// of page p are a contiguous range of row ids.
+//
+// <table>.pagedir holds a small header and the slot count of every
+// page; it is the only file read when the table is opened.
+class PagedStore {
+public:
+    static std::unique_ptr<PagedStore> open(const std::filesystem::path& pages_path,
+                                            const std::filesystem::path& dir_path,
+                                            size_t pool_frames = BufferPool::kDefaultFrames);
+    
+    size_t row_count() const { return row_count_; }
+    size_t page_count() const { return slot_counts_.size(); }
+    
+    // False if the row does not fit in an empty page
+    bool append(const std::vector<std::string>& values);
+    
+    // Safe to call from several threads while no rows are appended
+    bool read_row(size_t row_id, std::vector<std::string>& values);
+    
+    // Write dirty pages and the page directory
+    bool flush();
+    
+    // Largest encoded row a page can hold
+    static size_t max_row_bytes();
+    
+    // The bytes of a flushed .pages or .pagedir file that appending rows
+    // can still rewrite in place: the last page, or the directory header
+    // and last entry. Everything before them is only ever appended to.
+    struct MutableParts {
+        uint64_t size = 0;
+        std::vector<std::pair<uint64_t, std::string>> ranges; // Offset, bytes
+    };
+    static bool read_mutable_parts(const std::filesystem::path& path, bool directory,
+                                   MutableParts* parts);
+    
+    // Replace a hard link to a page file with a private copy of the file as
+    // it was when `parts` were read, however much has been appended since
+    static bool freeze_copy(const std::filesystem::path& link, const MutableParts& parts);
+    
+private:
+    PagedStore(const std::filesystem::path& pages_path, const std::filesystem::path& dir_path,
+               size_t pool_frames);
+    
+    std::filesystem::path dir_path_;
+    PageFile file_;
+    BufferPool pool_;
+    
+    std::vector<uint32_t> slot_counts_; // Rows per page
+    std::vector<size_t> first_rows_;    // Row id of each page's first slot
+    size_t row_count_ = 0;
+    size_t dir_dirty_from_ = 0;         // First directory entry not yet on disk
+    std::atomic<size_t> last_page_{0};  // Cache for sequential row lookups
+    
+    bool load_directory();
+    size_t page_of_row(size_t row_id);
+};
+
+} // namespace vsdb
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <system_error>
+
+namespace vsdb {
+
+// Write `target` through a temporary file that is renamed over it, so
+// readers (and hard links taken for snapshots) only ever see a complete
+// old or new file, never a partial one.
+inline bool replace_file(const std::filesystem::path& target,
+                         const std::function<bool(const std::filesystem::path&)>& write) {
+    std::filesystem::path tmp_path = target;
+    tmp_path += ".tmp";
+    
+    std::error_code ec;
+    if (!write(tmp_path)) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    
+    std::filesystem::rename(tmp_path, target, ec);
+    return !ec;
+}
+
+} // namespace vsdb
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace vsdb {
+
+// FNV-1a over a byte range; detects torn or corrupted binary files
+inline uint64_t fnv1a_checksum(const char* data, size_t size) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Appends fixed-width integers and length-prefixed strings to a buffer
+class ByteEncoder {
+public:
+    void u8(uint8_t v) { out_.push_back(static_cast<char>(v)); }
+    void u32(uint32_t v) { out_.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+    void u64(uint64_t v) { out_.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+    void str(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        out_ += s;
+    }
+    std::string& bytes() { return out_; }
+    
+private:
+    std::string out_;
+};
+
+// Reads what ByteEncoder wrote; ok() turns false on the first overrun
+class ByteDecoder {
+public:
+    ByteDecoder(const char* data, size_t size) : data_(data), size_(size) {}
+    
+    bool ok() const { return ok_; }
+    bool at_end() const { return pos_ == size_; }
+    uint8_t u8() { uint8_t v = 0; read(&v, sizeof(v)); return v; }
+    uint32_t u32() { uint32_t v = 0; read(&v, sizeof(v)); return v; }
+    uint64_t u64() { uint64_t v = 0; read(&v, sizeof(v)); return v; }
+    std::string str() {
+        uint32_t len = u32();
+        if (!ok_ || len > size_ - pos_) {
+            ok_ = false;
+            return "";
+        }
+        std::string s(data_ + pos_, len);
+        pos_ += len;
+        return s;
+    }
+    
+private:
+    void read(void* dst, size_t n) {
+        if (!ok_ || n > size_ - pos_) {
+            ok_ = false;
+            return;
+        }
+        std::memcpy(dst, data_ + pos_, n);
+        pos_ += n;
+    }
+    
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace vsdb
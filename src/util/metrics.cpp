@@ -0,0 +1,141 @@
+#include "util/metrics.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace vsdb {
+
+namespace {
+
+const char* counter_name(Counter counter) {
+    switch (counter) {
+        case Counter::BYTES_READ:           return "bytes_read";
+        case Counter::BYTES_WRITTEN:        return "bytes_written";
+        case Counter::OBJECTS_STORED:       return "objects_stored";
+        case Counter::OBJECTS_DEDUPLICATED: return "objects_deduplicated";
+        case Counter::OBJECTS_RESTORED:     return "objects_restored";
+        case Counter::OBJECTS_PRUNED:       return "objects_pruned";
+        case Counter::OBJECTS_VERIFIED:     return "objects_verified";
+        case Counter::TABLES_LOADED:        return "tables_loaded";
+        case Counter::TABLES_COMPACTED:     return "tables_compacted";
+        case Counter::ROWS_LOADED:          return "rows_loaded";
+        case Counter::ROWS_INSERTED:        return "rows_inserted";
+        case Counter::ROWS_UPDATED:         return "rows_updated";
+        case Counter::ROWS_DELETED:         return "rows_deleted";
+        case Counter::ROWS_RETURNED:        return "rows_returned";
+        case Counter::ROWS_SCANNED:         return "rows_scanned";
+        case Counter::BLOCKS_HASHED:        return "blocks_hashed";
+        case Counter::INDEX_LOOKUPS:        return "index_lookups";
+        case Counter::BLOCKS_SKIPPED:       return "blocks_skipped";
+        case Counter::BLOOM_NEGATIVES:      return "bloom_negatives";
+        case Counter::BLOOM_FALSE_POSITIVES: return "bloom_false_positives";
+        case Counter::CACHE_HITS:           return "cache_hits";
+        case Counter::CACHE_MISSES:         return "cache_misses";
+        case Counter::CACHE_EVICTIONS:      return "cache_evictions";
+        case Counter::PAGES_READ:           return "pages_read";
+        case Counter::PAGES_WRITTEN:        return "pages_written";
+        case Counter::PAGES_EVICTED:        return "pages_evicted";
+        default:                            return "unknown";
+    }
+}
+
+size_t bucket_for(uint64_t nanos) {
+    size_t bucket = 0;
+    while (nanos > 1 && bucket < Histogram::kBuckets - 1) {
+        nanos >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// Format nanoseconds with a readable unit
+std::string format_duration(uint64_t nanos) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    if (nanos < 1000) {
+        ss << nanos << "ns";
+    } else if (nanos < 1000 * 1000) {
+        ss << nanos / 1e3 << "us";
+    } else if (nanos < 1000ull * 1000 * 1000) {
+        ss << nanos / 1e6 << "ms";
+    } else {
+        ss << nanos / 1e9 << "s";
+    }
+    return ss.str();
+}
+
+} // namespace
+
+const char* timer_name(Timer timer) {
+    switch (timer) {
+        case Timer::LOAD_TABLES:   return "load_tables";
+        case Timer::TABLE_LOAD:    return "table_load";
+        case Timer::TABLE_SAVE:    return "table_save";
+        case Timer::STORE_FILE:    return "store_file";
+        case Timer::RESTORE_FILE:  return "restore_file";
+        case Timer::GENERATE_HASH: return "generate_hash";
+        case Timer::COMMIT:        return "commit";
+        case Timer::CHECKOUT:      return "checkout";
+        case Timer::COMMAND:       return "command";
+        default:                   return "unknown";
+    }
+}
+
+void Histogram::record(uint64_t nanos) {
+    buckets_[bucket_for(nanos)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(nanos, std::memory_order_relaxed);
+
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (nanos > current &&
+           !max_.compare_exchange_weak(current, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(n * p / 100.0);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            uint64_t upper = (i + 1 >= 64) ? UINT64_MAX : (uint64_t(1) << (i + 1));
+            return std::min(upper, max());
+        }
+    }
+    return max();
+}
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::report(std::ostream& out) const {
+    out << "--- stats ---\n";
+
+    for (size_t i = 0; i < static_cast<size_t>(Counter::COUNT); ++i) {
+        uint64_t value = counters_[i].load(std::memory_order_relaxed);
+        if (value == 0) continue;
+        out << std::left << std::setw(24) << counter_name(static_cast<Counter>(i))
+            << value << "\n";
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(Timer::COUNT); ++i) {
+        const Histogram& h = timers_[i];
+        if (h.count() == 0) continue;
+        out << std::left << std::setw(24) << timer_name(static_cast<Timer>(i))
+            << "n=" << h.count()
+            << " total=" << format_duration(h.total())
+            << " p50=" << format_duration(h.percentile(50))
+            << " p99=" << format_duration(h.percentile(99))
+            << " max=" << format_duration(h.max()) << "\n";
+    }
+}
+
+} // namespace vsdb
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include "util/trace.h"
+
+namespace vsdb {
+
+// Monotonic counters tracked for every process
+enum class Counter {
+    BYTES_READ,
+    BYTES_WRITTEN,
+    OBJECTS_STORED,
+    OBJECTS_DEDUPLICATED,
+    OBJECTS_RESTORED,
+    OBJECTS_PRUNED,
+    OBJECTS_VERIFIED,
+    TABLES_LOADED,
+    TABLES_COMPACTED,
+    ROWS_LOADED,
+    ROWS_INSERTED,
+    ROWS_UPDATED,
+    ROWS_DELETED,
+    ROWS_RETURNED,
+    ROWS_SCANNED,
+    BLOCKS_HASHED,
+    INDEX_LOOKUPS,
+    BLOCKS_SKIPPED,
+    BLOOM_NEGATIVES,
+    BLOOM_FALSE_POSITIVES,
+    CACHE_HITS,
+    CACHE_MISSES,
+    CACHE_EVICTIONS,
+    PAGES_READ,
+    PAGES_WRITTEN,
+    PAGES_EVICTED,
+    COUNT
+};
+
+// Timed phases; each one feeds a latency histogram
+enum class Timer {
+    LOAD_TABLES,
+    TABLE_LOAD,
+    TABLE_SAVE,
+    STORE_FILE,
+    RESTORE_FILE,
+    GENERATE_HASH,
+    COMMIT,
+    CHECKOUT,
+    COMMAND,
+    COUNT
+};
+
+// Lock-free latency histogram with power-of-two nanosecond buckets
+class Histogram {
+public:
+    static constexpr size_t kBuckets = 64;
+
+    void record(uint64_t nanos);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t total() const { return total_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the given percentile (0-100)
+    uint64_t percentile(double p) const;
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+class Metrics {
+public:
+    static Metrics& instance();
+
+    void add(Counter counter, uint64_t delta = 1) {
+        counters_[static_cast<size_t>(counter)].fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    void record(Timer timer, uint64_t nanos) {
+        timers_[static_cast<size_t>(timer)].record(nanos);
+    }
+
+    uint64_t get(Counter counter) const {
+        return counters_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    const Histogram& histogram(Timer timer) const {
+        return timers_[static_cast<size_t>(timer)];
+    }
+
+    // Print all non-zero counters and timers
+    void report(std::ostream& out) const;
+
+private:
+    Metrics() = default;
+
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::COUNT)> counters_{};
+    std::array<Histogram, static_cast<size_t>(Timer::COUNT)> timers_{};
+};
+
+const char* timer_name(Timer timer);
+
+// Records the lifetime of the enclosing scope into a timer histogram,
+// and as a span named after the timer while tracing
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Timer timer)
+        : timer_(timer), span_(timer_name(timer)), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        Metrics::instance().record(
+            timer_,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()
+        );
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    TraceSpan& span() { return span_; }
+
+private:
+    Timer timer_;
+    TraceSpan span_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace vsdb
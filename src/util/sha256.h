@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace vsdb {
+
+// Incremental SHA-256 (FIPS 180-4)
+class Sha256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+    
+    Sha256();
+    
+    void update(const void* data, size_t size);
+    void update(std::string_view data) { update(data.data(), data.size()); }
+    Digest finish();
+    
+    // Lowercase hex digest of `data`
+    static std::string hex(std::string_view data);
+    static std::string to_hex(const Digest& digest);
+    
+private:
+    std::array<uint32_t, 8> state_;
+    std::array<uint8_t, 64> block_;
+    size_t block_size_ = 0;
+    uint64_t total_bytes_ = 0;
+    
+    void compress(const uint8_t* block);
+};
+
+} // namespace vsdb
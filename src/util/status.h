@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <utility>
+
+namespace vsdb {
+
+// Outcome of a library call. Errors carry a message for the caller to
+// report; the library itself never writes to the console.
+class [[nodiscard]] Status {
+public:
+    Status() = default;
+    
+    static Status ok() { return Status(); }
+    static Status error(std::string message) {
+        Status status;
+        status.ok_ = false;
+        status.message_ = std::move(message);
+        return status;
+    }
+    
+    bool is_ok() const { return ok_; }
+    explicit operator bool() const { return ok_; }
+    const std::string& message() const { return message_; }
+    
+private:
+    bool ok_ = true;
+    std::string message_;
+};
+
+} // namespace vsdb
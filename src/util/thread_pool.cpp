@@ -0,0 +1,63 @@
+#include "util/thread_pool.h"
+#include <algorithm>
+
+namespace vsdb {
+
+ThreadPool::ThreadPool(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this]() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+                    
+                    if (tasks_.empty()) {
+                        return;
+                    }
+                    
+                    task = std::move(tasks_.front());
+                    tasks_.pop();
+                }
+                task();
+            }
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::default_threads() {
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+std::vector<std::pair<size_t, size_t>> partition_range(size_t count, size_t parts) {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    parts = std::max<size_t>(std::min(parts, count), 1);
+    
+    size_t chunk = count / parts;
+    size_t extra = count % parts;
+    size_t begin = 0;
+    
+    for (size_t i = 0; i < parts; ++i) {
+        size_t end = begin + chunk + (i < extra ? 1 : 0);
+        ranges.emplace_back(begin, end);
+        begin = end;
+    }
+    
+    return ranges;
+}
+
+} // namespace vsdb
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vsdb {
+
+// Fixed-size worker pool. Tasks run in submission order; the destructor
+// drains the queue and joins all workers.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = default_threads());
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    template<typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<F>>;
+    
+    size_t size() const { return workers_.size(); }
+    
+    // Hardware concurrency, at least 1
+    static size_t default_threads();
+    
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+template<typename F>
+auto ThreadPool::submit(F&& task) -> std::future<std::invoke_result_t<F>> {
+    using Result = std::invoke_result_t<F>;
+    
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+    std::future<Result> future = packaged->get_future();
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.emplace([packaged]() { (*packaged)(); });
+    }
+    cv_.notify_one();
+    
+    return future;
+}
+
+// Split [0, count) into at most `parts` contiguous ranges
+std::vector<std::pair<size_t, size_t>> partition_range(size_t count, size_t parts);
+
+} // namespace vsdb
@@ -0,0 +1,128 @@
+#include "util/trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+
+namespace vsdb {
+
+std::atomic<bool> Tracer::enabled_{false};
+
+namespace {
+
+// Small sequential ids in place of std::thread::id; the first thread
+// to record a span is 1
+uint32_t current_thread() {
+    static std::atomic<uint32_t> next{1};
+    thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void write_json_string(std::ostream& out, std::string_view text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                << std::dec << std::setfill(' ');
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+// Timestamps are in microseconds
+void write_micros(std::ostream& out, uint64_t nanos) {
+    out << nanos / 1000 << '.' << std::setw(3) << std::setfill('0') << nanos % 1000 << std::setfill(' ');
+}
+
+const bool kStartedFromEnvironment = [] {
+    const char* path = std::getenv("VSDB_TRACE");
+    if (path && *path) {
+        Tracer::instance().start(path);
+        return true;
+    }
+    return false;
+}();
+
+} // namespace
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::~Tracer() {
+    if (enabled()) {
+        flush();
+    }
+}
+
+void Tracer::start(const std::filesystem::path& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled()) {
+        origin_ = std::chrono::steady_clock::now();
+    }
+    path_ = path;
+    written_ = 0;
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::record(const char* name, std::string detail,
+                    std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end) {
+    uint32_t thread = current_thread();
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Spans opened just before start() may predate the origin
+    auto since = std::max(start - origin_, std::chrono::steady_clock::duration::zero());
+    auto duration = end - start;
+    events_.push_back({
+        name,
+        std::move(detail),
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(since).count()),
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()),
+        thread
+    });
+}
+
+bool Tracer::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty() || (written_ == events_.size() && written_ > 0)) {
+        return true;
+    }
+    
+    std::ofstream out(path_, std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    
+    // Complete ("X") events; nesting is recovered from the timestamps
+    const long pid = static_cast<long>(getpid());
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events_.size(); ++i) {
+        const Event& event = events_[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        write_json_string(out, event.name);
+        out << ",\"cat\":\"vsdb\",\"ph\":\"X\",\"ts\":";
+        write_micros(out, event.start_ns);
+        out << ",\"dur\":";
+        write_micros(out, event.duration_ns);
+        out << ",\"pid\":" << pid << ",\"tid\":" << event.thread;
+        if (!event.detail.empty()) {
+            out << ",\"args\":{\"detail\":";
+            write_json_string(out, event.detail);
+            out << "}";
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+    
+    written_ = events_.size();
+    return static_cast<bool>(out.flush());
+}
+
+} // namespace vsdb
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vsdb {
+
+// Collects timed spans and writes them as Chrome trace-event JSON
+// (chrome://tracing, Perfetto). Off unless started by --trace or the
+// VSDB_TRACE environment variable, which names the output file; while
+// off a span costs one relaxed atomic load. The file is rewritten by
+// flush() and when the process exits.
+class Tracer {
+public:
+    static Tracer& instance();
+    
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    
+    void start(const std::filesystem::path& path);
+    void record(const char* name, std::string detail,
+                std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end);
+    bool flush();
+    
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+    
+private:
+    struct Event {
+        const char* name;
+        std::string detail;
+        uint64_t start_ns;
+        uint64_t duration_ns;
+        uint32_t thread;
+    };
+    
+    Tracer() = default;
+    ~Tracer();
+    
+    static std::atomic<bool> enabled_;
+    
+    std::mutex mutex_;
+    std::filesystem::path path_;
+    std::chrono::steady_clock::time_point origin_;
+    std::vector<Event> events_;
+    size_t written_ = 0; // Events in the file as last flushed
+};
+
+// One trace span covering the lifetime of the enclosing scope
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name)
+        : name_(Tracer::enabled() ? name : nullptr) {
+        if (name_) start_ = std::chrono::steady_clock::now();
+    }
+    
+    ~TraceSpan() {
+        if (name_) {
+            Tracer::instance().record(name_, std::move(detail_), start_, std::chrono::steady_clock::now());
+        }
+    }
+    
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    
+    // Shown with the span, e.g. the file or table it worked on; ignored
+    // while tracing is off
+    void annotate(std::string_view detail) {
+        if (name_) detail_ = detail;
+    }
+    void annotate_file(const std::filesystem::path& file) {
+        if (name_) detail_ = file.filename().string();
+    }
+    
+private:
+    const char* name_;
+    std::string detail_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace vsdb
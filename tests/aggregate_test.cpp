@@ -0,0 +1,129 @@
+#include "query/aggregate.h"
+#include "check.h"
+#include <chrono>
+
+using namespace vsdb;
+
+namespace {
+
+// 100 rows in groups "a" (even i) and "b" (odd i); rows with i ending
+// in 0 or 5 leave v, f and t empty
+std::vector<Record> make_rows() {
+    std::vector<Record> rows;
+    for (int i = 0; i < 100; ++i) {
+        bool blank = i % 10 == 0 || i % 10 == 5;
+        rows.push_back({{i % 2 ? "b" : "a",
+                         blank ? "" : std::to_string(i),
+                         blank ? "" : std::to_string(i) + ".5",
+                         blank ? "" : "t" + std::to_string(100 + i)}});
+    }
+    return rows;
+}
+
+const std::vector<Column> kColumns = {
+    {"g", DataType::TEXT},
+    {"v", DataType::INT},
+    {"f", DataType::FLOAT},
+    {"t", DataType::TEXT},
+};
+
+std::vector<AggregateSpec> make_specs() {
+    std::vector<AggregateSpec> specs;
+    for (const char* expr : {"count(*)", "count(v)", "sum(v)", "min(v)", "max(v)", "avg(v)",
+                             "count(f)", "min(f)", "count(t)", "min(t)", "max(t)"}) {
+        specs.push_back(*AggregateSpec::parse(expr));
+    }
+    return specs;
+}
+
+// Group "a" holds 50 rows, 10 of them (i = 0, 10, ..., 90) blank;
+// group "b" holds 50 rows, 10 of them (i = 5, 15, ..., 95) blank
+void check_result(const AggregateResult& result) {
+    CHECK_EQ(result.rows.size(), size_t{2});
+    for (const auto& row : result.rows) {
+        const auto& v = row.values;
+        if (v[0] == "a") {
+            CHECK_EQ(v[1], "50");
+            CHECK_EQ(v[2], "40");
+            CHECK_EQ(v[3], "2000");
+            CHECK_EQ(v[4], "2");
+            CHECK_EQ(v[5], "98");
+            CHECK_EQ(v[6], "50");
+            CHECK_EQ(v[7], "40");
+            CHECK_EQ(v[8], "2.5");
+            CHECK_EQ(v[9], "40");
+            CHECK_EQ(v[10], "t102");
+            CHECK_EQ(v[11], "t198");
+        } else {
+            CHECK_EQ(v[0], "b");
+            CHECK_EQ(v[1], "50");
+            CHECK_EQ(v[2], "40");
+            CHECK_EQ(v[4], "1");
+            CHECK_EQ(v[5], "99");
+            CHECK_EQ(v[10], "t101");
+        }
+    }
+}
+
+void test_rows_in_memory() {
+    TableSchema schema;
+    schema.table_name = "t";
+    schema.columns = kColumns;
+    
+    Aggregator aggregator(schema, make_specs(), {"g"});
+    CHECK(aggregator.validate().is_ok());
+    check_result(aggregator.run(make_rows(), 1));
+    check_result(aggregator.run(make_rows(), 4));
+}
+
+// Saved tables encode the low-cardinality group column, so the scan
+// groups on dictionary codes
+void test_dictionary_coded_groups() {
+    auto root = std::filesystem::temp_directory_path() /
+        ("vsdb-aggregate-test-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    {
+        Database db(root);
+        CHECK(db.initialize().is_ok());
+        CHECK(db.create_table("t", kColumns).is_ok());
+        for (const auto& row : make_rows()) {
+            CHECK(db.insert_into("t", row).is_ok());
+        }
+        
+        auto table = db.get_table("t");
+        Aggregator aggregator(table->get_schema(), make_specs(), {"g"});
+        for (size_t threads : {1, 3}) {
+            std::unique_ptr<TableCursor> cursor;
+            CHECK(db.open_cursor("t", ScanOptions(), &cursor).is_ok());
+            check_result(aggregator.run(*cursor, threads));
+            CHECK(cursor->batch_codes(0) != nullptr);
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+}
+
+// With no values left a column aggregate is empty, like the exporter's null
+void test_all_empty() {
+    TableSchema schema;
+    schema.table_name = "t";
+    schema.columns = kColumns;
+    
+    std::vector<Record> rows = {{{"a", "", "", ""}}, {{"a", "", "", ""}}};
+    Aggregator aggregator(schema, make_specs(), {});
+    auto result = aggregator.run(rows, 1);
+    CHECK_EQ(result.rows.size(), size_t{1});
+    CHECK_EQ(result.rows[0].values[0], "2");
+    CHECK_EQ(result.rows[0].values[1], "0");
+    for (size_t i : {2, 3, 4, 5, 7, 9, 10}) {
+        CHECK_EQ(result.rows[0].values[i], "");
+    }
+}
+
+} // namespace
+
+int main() {
+    test_rows_in_memory();
+    test_dictionary_coded_groups();
+    test_all_empty();
+    return check_failures();
+}
@@ -0,0 +1,105 @@
+#include "btree/btree.h"
+#include "db/value.h"
+#include "check.h"
+
+using namespace vsdb;
+
+namespace {
+
+const std::vector<std::string> kNames = {"delta", "alpha", "echo", "charlie", "bravo"};
+
+CompositeKey key(int64_t id) {
+    return {TypedValue::parse(DataType::INT, std::to_string(id))};
+}
+
+CompositeKey key(int64_t id, const std::string& name) {
+    return {TypedValue::parse(DataType::INT, std::to_string(id)), TypedValue::parse(DataType::TEXT, name)};
+}
+
+// Order 3 splits nodes often enough to exercise every level
+BTree<CompositeKey, int, CompositeKeyLess> make_tree(CompositeKeyLess less) {
+    BTree<CompositeKey, int, CompositeKeyLess> tree(3, std::move(less));
+    int value = 0;
+    for (int64_t id = 9; id >= 0; --id) {
+        for (const auto& name : kNames) {
+            tree.insert(key(id, name), value++);
+        }
+    }
+    return tree;
+}
+
+std::string describe(const CompositeKey& k) {
+    return k[0].to_string() + "/" + k[1].text_value;
+}
+
+void test_order_and_search() {
+    auto tree = make_tree(CompositeKeyLess{});
+    
+    std::vector<CompositeKey> keys;
+    tree.traverse([&](const CompositeKey& k, const int&) { keys.push_back(k); });
+    CHECK_EQ(keys.size(), size_t{50});
+    for (size_t i = 1; i < keys.size(); ++i) {
+        CHECK(CompositeKeyLess{}(keys[i - 1], keys[i]));
+    }
+    CHECK_EQ(describe(keys.front()), "0/alpha");
+    CHECK_EQ(describe(keys.back()), "9/echo");
+    
+    CHECK(tree.search(key(4, "charlie")).has_value());
+    CHECK(!tree.search(key(4, "foxtrot")).has_value());
+    CHECK(!tree.search(key(4)).has_value());
+}
+
+// A one-column prefix sorts before every key it starts, so [{4}, {5}]
+// returns exactly the keys whose first column is 4
+void test_prefix_scan() {
+    auto tree = make_tree(CompositeKeyLess{});
+    
+    std::string scanned;
+    tree.scan_range(key(4), key(5), [&](const CompositeKey& k, const int&) {
+        scanned += describe(k) + " ";
+    });
+    CHECK_EQ(scanned, "4/alpha 4/bravo 4/charlie 4/delta 4/echo ");
+    
+    // Open-ended on either side
+    size_t below = 0;
+    tree.scan_range(std::nullopt, key(2), [&](const CompositeKey&, const int&) { below++; });
+    CHECK_EQ(below, size_t{10});
+    size_t above = 0;
+    tree.scan_range(key(8), std::nullopt, [&](const CompositeKey&, const int&) { above++; });
+    CHECK_EQ(above, size_t{10});
+}
+
+void test_descending_column() {
+    auto tree = make_tree(CompositeKeyLess{{false, true}});
+    
+    std::string scanned;
+    tree.scan_range(key(7), key(8), [&](const CompositeKey& k, const int&) {
+        scanned += describe(k) + " ";
+    });
+    CHECK_EQ(scanned, "7/echo 7/delta 7/charlie 7/bravo 7/alpha ");
+    
+    // Descending first column: the prefix {3} comes after the keys
+    // starting with 4 and before those starting with 3
+    auto reversed = make_tree(CompositeKeyLess{{true}});
+    std::string first;
+    reversed.traverse([&](const CompositeKey& k, const int&) {
+        if (first.empty()) first = describe(k);
+    });
+    CHECK_EQ(first, "9/alpha");
+    
+    size_t count = 0;
+    reversed.scan_range(key(3), key(2), [&](const CompositeKey& k, const int&) {
+        CHECK_EQ(k[0].int_value, int64_t{3});
+        count++;
+    });
+    CHECK_EQ(count, size_t{5});
+}
+
+} // namespace
+
+int main() {
+    test_order_and_search();
+    test_prefix_scan();
+    test_descending_column();
+    return check_failures();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// Minimal checks for the test executables: a failed check is reported
+// and the test keeps going; main returns the failure count.
+
+inline int& check_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                                    \
+    do {                                                                               \
+        if (!(cond)) {                                                                 \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n"; \
+            check_failures()++;                                                        \
+        }                                                                              \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                     \
+    do {                                                                               \
+        const auto check_actual = (actual);                                            \
+        const auto check_expected = (expected);                                        \
+        if (!(check_actual == check_expected)) {                                       \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #actual "\n"              \
+                      << "  expected: " << check_expected << "\n"                      \
+                      << "  actual:   " << check_actual << "\n";                       \
+            check_failures()++;                                                        \
+        }                                                                              \
+    } while (0)
@@ -0,0 +1,86 @@
+#include "io/exporter.h"
+#include "check.h"
+#include <sstream>
+
+using namespace vsdb;
+
+namespace {
+
+Table make_table() {
+    TableSchema schema;
+    schema.table_name = "t";
+    schema.columns = {
+        {"id", DataType::INT},
+        {"name", DataType::TEXT},
+        {"score", DataType::FLOAT},
+        {"ok", DataType::BOOL},
+    };
+    
+    Table table("t", schema);
+    const std::vector<std::vector<std::string>> rows = {
+        {"1", "plain", "1.5", "true"},
+        {"2", "say \"hi\"", "", "false"},
+        {"3", "a,b", "2", "1"},
+        {"4", "line1\nline2\r\n", "x", "0"},
+        {"12abc", "tab\there\x01\x1f back\\slash", "-0.25", "TRUE"},
+    };
+    for (const auto& values : rows) {
+        CHECK(table.insert({values}).is_ok());
+    }
+    return table;
+}
+
+std::string export_as(const Table& table, ExportFormat format, size_t threads = 1, size_t segment_rows = 1024) {
+    ExportOptions options;
+    options.format = format;
+    options.threads = threads;
+    options.segment_rows = segment_rows;
+    
+    std::ostringstream out;
+    size_t exported = 0;
+    CHECK(export_table(table, options, out, &exported).is_ok());
+    CHECK_EQ(exported, table.row_count());
+    return out.str();
+}
+
+// Fields with commas, quotes, CR or LF are quoted and quotes doubled;
+// other control characters pass through
+void test_csv_escaping() {
+    Table table = make_table();
+    CHECK_EQ(export_as(table, ExportFormat::CSV),
+             "id,name,score,ok\n"
+             "1,plain,1.5,true\n"
+             "2,\"say \"\"hi\"\"\",,false\n"
+             "3,\"a,b\",2,1\n"
+             "4,\"line1\nline2\r\n\",x,0\n"
+             "12abc,tab\there\x01\x1f back\\slash,-0.25,TRUE\n");
+}
+
+// Strings are JSON-escaped; values are typed by column, empty ones are
+// null and unparsable ones stay strings
+void test_jsonl_escaping() {
+    Table table = make_table();
+    CHECK_EQ(export_as(table, ExportFormat::JSONL),
+             "{\"id\":1,\"name\":\"plain\",\"score\":1.5,\"ok\":true}\n"
+             "{\"id\":2,\"name\":\"say \\\"hi\\\"\",\"score\":null,\"ok\":false}\n"
+             "{\"id\":3,\"name\":\"a,b\",\"score\":2,\"ok\":true}\n"
+             "{\"id\":4,\"name\":\"line1\\nline2\\r\\n\",\"score\":\"x\",\"ok\":false}\n"
+             "{\"id\":\"12abc\",\"name\":\"tab\\there\\u0001\\u001f back\\\\slash\",\"score\":-0.25,\"ok\":true}\n");
+}
+
+// Segments formatted in parallel are written in row order
+void test_parallel_order() {
+    Table table = make_table();
+    for (auto format : {ExportFormat::CSV, ExportFormat::JSONL, ExportFormat::BINARY}) {
+        CHECK_EQ(export_as(table, format, 3, 1), export_as(table, format));
+    }
+}
+
+} // namespace
+
+int main() {
+    test_csv_escaping();
+    test_jsonl_escaping();
+    test_parallel_order();
+    return check_failures();
+}
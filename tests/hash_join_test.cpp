@@ -0,0 +1,144 @@
+#include "query/hash_join.h"
+#include "check.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace vsdb;
+
+namespace {
+
+TableSchema make_schema(const std::string& name, DataType key_type) {
+    TableSchema schema;
+    schema.table_name = name;
+    schema.columns = {{"k", key_type}, {"v", DataType::TEXT}};
+    return schema;
+}
+
+// Rows (k, "<prefix><i>") with k = key(i)
+template <typename Key>
+std::vector<Record> make_rows(size_t count, const std::string& prefix, Key key) {
+    std::vector<Record> rows;
+    for (size_t i = 0; i < count; ++i) {
+        rows.push_back({{key(i), prefix + std::to_string(i) + std::string(40, 'x')}});
+    }
+    return rows;
+}
+
+BatchSource source_of(const std::vector<Record>& rows) {
+    size_t next = 0;
+    return [&rows, next](std::vector<Record>& batch) mutable {
+        batch.clear();
+        while (next < rows.size() && batch.size() < 100) {
+            batch.push_back(rows[next++]);
+        }
+        return !batch.empty();
+    };
+}
+
+// Numeric keys compare by value, so "3" joins "3.0"
+std::vector<std::vector<std::string>> nested_loop(const std::vector<Record>& left,
+                                                  const std::vector<Record>& right,
+                                                  bool numeric) {
+    auto key = [numeric](const Record& record) {
+        return numeric ? std::to_string(std::stod(record.values[0])) : record.values[0];
+    };
+    std::vector<std::string> right_keys;
+    for (const auto& r : right) {
+        right_keys.push_back(key(r));
+    }
+    
+    std::vector<std::vector<std::string>> out;
+    for (const auto& l : left) {
+        std::string left_key = key(l);
+        for (size_t i = 0; i < right.size(); ++i) {
+            if (left_key == right_keys[i]) {
+                out.push_back({l.values[0], l.values[1], right[i].values[0], right[i].values[1]});
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Joins the rows with the given budget and checks the result against a
+// nested loop join
+void check_join(const TableSchema& left_schema, const TableSchema& right_schema,
+                  const std::vector<Record>& left, const std::vector<Record>& right,
+                  size_t memory_budget, size_t threads) {
+    auto spill_dir = std::filesystem::temp_directory_path() /
+        ("vsdb-hash-join-test-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::filesystem::create_directories(spill_dir);
+    
+    HashJoin join(left_schema, right_schema, {"k", "k"});
+    CHECK(join.validate().is_ok());
+    CHECK_EQ(join.schema().columns.size(), size_t(4));
+    CHECK_EQ(join.schema().columns[2].name, right_schema.table_name + ".k");
+    
+    std::vector<std::vector<std::string>> joined;
+    {
+        std::unique_ptr<JoinCursor> cursor;
+        CHECK(join.run(source_of(left), source_of(right), memory_budget, spill_dir, &cursor, threads).is_ok());
+        std::vector<Record> batch;
+        while (cursor && cursor->next_batch(batch)) {
+            for (auto& record : batch) {
+                joined.push_back(std::move(record.values));
+            }
+        }
+        CHECK(cursor && cursor->status().is_ok());
+    }
+    
+    std::sort(joined.begin(), joined.end());
+    CHECK(joined == nested_loop(left, right, left_schema.columns[0].type != DataType::TEXT));
+    
+    // Spill files are gone once the cursor is
+    CHECK(std::filesystem::is_empty(spill_dir));
+    std::error_code ec;
+    std::filesystem::remove_all(spill_dir, ec);
+}
+
+void test_in_memory() {
+    auto left_schema = make_schema("l", DataType::INT);
+    auto right_schema = make_schema("r", DataType::INT);
+    auto left = make_rows(3000, "l", [](size_t i) { return std::to_string(i % 700); });
+    auto right = make_rows(500, "r", [](size_t i) { return std::to_string(i * 2); });
+    
+    check_join(left_schema, right_schema, left, right, 0, 1);
+    check_join(left_schema, right_schema, left, right, 0, 4);
+    check_join(right_schema, left_schema, right, left, HashJoin::kDefaultMemoryBudget, 2);
+    
+    // Nothing joins an empty side
+    check_join(left_schema, right_schema, {}, right, 0, 1);
+    check_join(left_schema, right_schema, left, {}, 0, 1);
+}
+
+// Budgets far below the inputs spill them, and partitions still over
+// budget are split again
+void test_spilled() {
+    auto left_schema = make_schema("l", DataType::INT);
+    auto right_schema = make_schema("r", DataType::FLOAT);
+    auto left = make_rows(6000, "l", [](size_t i) { return std::to_string(i % 2500); });
+    auto right = make_rows(3000, "r", [](size_t i) { return std::to_string(i % 2000) + ".0"; });
+    
+    check_join(left_schema, right_schema, left, right, 512 * 1024, 1);
+    check_join(left_schema, right_schema, left, right, 16 * 1024, 4);
+    check_join(left_schema, right_schema, left, right, 1024, 2);
+}
+
+// One key everywhere cannot be split; it is joined over budget
+void test_skewed() {
+    auto left_schema = make_schema("l", DataType::TEXT);
+    auto right_schema = make_schema("r", DataType::TEXT);
+    auto left = make_rows(300, "l", [](size_t) { return std::string("same"); });
+    auto right = make_rows(200, "r", [](size_t i) { return std::string(i % 2 ? "same" : "other"); });
+    
+    check_join(left_schema, right_schema, left, right, 1024, 2);
+}
+
+} // namespace
+
+int main() {
+    test_in_memory();
+    test_spilled();
+    test_skewed();
+    return check_failures();
+}
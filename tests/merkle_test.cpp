@@ -0,0 +1,60 @@
+#include "gitstore/merkle.h"
+#include "check.h"
+
+using vsdb::MerkleStep;
+using vsdb::MerkleTree;
+
+namespace {
+
+const std::vector<std::string> kLeaves = {"file:a.data:01", "file:b.data:02", "rows:a:03",
+                                          "rows:b:04", "rows:c:05"};
+
+// Every leaf, including the odd one that moves up unchanged
+void test_proofs_verify() {
+    MerkleTree tree(kLeaves);
+    CHECK_EQ(tree.leaf_count(), kLeaves.size());
+    
+    for (size_t i = 0; i < kLeaves.size(); ++i) {
+        auto proof = tree.proof(i);
+        CHECK_EQ(MerkleTree::root_from_proof(MerkleTree::leaf_hash(kLeaves[i]), proof), tree.root());
+    }
+}
+
+void test_tampered_proofs_fail() {
+    MerkleTree tree(kLeaves);
+    const size_t index = 2;
+    const std::string leaf = MerkleTree::leaf_hash(kLeaves[index]);
+    const auto proof = tree.proof(index);
+    CHECK(!proof.empty());
+    
+    // Another leaf with this leaf's proof
+    CHECK(MerkleTree::root_from_proof(MerkleTree::leaf_hash("rows:a:ff"), proof) != tree.root());
+    
+    for (size_t step = 0; step < proof.size(); ++step) {
+        auto sibling = proof;
+        sibling[step].sibling[0] = sibling[step].sibling[0] == '0' ? '1' : '0';
+        CHECK(MerkleTree::root_from_proof(leaf, sibling) != tree.root());
+        
+        auto side = proof;
+        side[step].sibling_left = !side[step].sibling_left;
+        CHECK(MerkleTree::root_from_proof(leaf, side) != tree.root());
+    }
+
+}
+
+void test_from_hashes() {
+    std::vector<std::string> hashes;
+    for (const auto& leaf : kLeaves) {
+        hashes.push_back(MerkleTree::leaf_hash(leaf));
+    }
+    CHECK_EQ(MerkleTree::from_hashes(hashes).root(), MerkleTree(kLeaves).root());
+}
+
+} // namespace
+
+int main() {
+    test_proofs_verify();
+    test_tampered_proofs_fail();
+    test_from_hashes();
+    return check_failures();
+}
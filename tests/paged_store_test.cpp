@@ -0,0 +1,117 @@
+#include "storage/paged_store.h"
+#include "db/database.h"
+#include "check.h"
+#include <chrono>
+
+using namespace vsdb;
+
+namespace {
+
+std::filesystem::path make_root(const std::string& name) {
+    auto root = std::filesystem::temp_directory_path() /
+        ("vsdb-" + name + "-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::filesystem::create_directories(root);
+    return root;
+}
+
+std::vector<std::string> make_row(int i) {
+    return {std::to_string(i), std::string(100, static_cast<char>('a' + i % 26))};
+}
+
+// A snapshot taken as hard links plus the mutable parts still reads as
+// the store did when it was taken, after rows fill the last page and
+// start new ones
+void test_freeze_copy() {
+    auto root = make_root("paged-store-test");
+    auto store = PagedStore::open(root / "t.pages", root / "t.pagedir");
+    CHECK(store != nullptr);
+    if (!store) return;
+    
+    for (int i = 0; i < 100; ++i) {
+        CHECK(store->append(make_row(i)));
+    }
+    CHECK(store->flush());
+    CHECK(store->page_count() > 1);
+    
+    PagedStore::MutableParts page_parts;
+    PagedStore::MutableParts dir_parts;
+    CHECK(PagedStore::read_mutable_parts(root / "t.pages", false, &page_parts));
+    CHECK(PagedStore::read_mutable_parts(root / "t.pagedir", true, &dir_parts));
+    std::filesystem::create_directories(root / "snap");
+    std::filesystem::create_hard_link(root / "t.pages", root / "snap" / "t.pages");
+    std::filesystem::create_hard_link(root / "t.pagedir", root / "snap" / "t.pagedir");
+    
+    for (int i = 100; i < 250; ++i) {
+        CHECK(store->append(make_row(i)));
+    }
+    CHECK(store->flush());
+    
+    CHECK(PagedStore::freeze_copy(root / "snap" / "t.pages", page_parts));
+    CHECK(PagedStore::freeze_copy(root / "snap" / "t.pagedir", dir_parts));
+    
+    auto frozen = PagedStore::open(root / "snap" / "t.pages", root / "snap" / "t.pagedir");
+    CHECK(frozen != nullptr);
+    if (frozen) {
+        CHECK_EQ(frozen->row_count(), size_t(100));
+        std::vector<std::string> values;
+        for (int i = 0; i < 100; ++i) {
+            CHECK(frozen->read_row(i, values));
+            CHECK(values == make_row(i));
+        }
+    }
+    
+    // The live files kept every row
+    CHECK_EQ(store->row_count(), size_t(250));
+    std::vector<std::string> values;
+    CHECK(store->read_row(249, values));
+    CHECK(values == make_row(249));
+    
+    store.reset();
+    frozen.reset();
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+}
+
+// Rows inserted while an async commit is pending stay out of it
+void test_commit_async() {
+    auto root = make_root("paged-commit-test");
+    {
+        Database db(root);
+        CHECK(db.initialize().is_ok());
+        CHECK(db.create_table("t", {{"id", DataType::INT}, {"name", DataType::TEXT}},
+                              StorageType::PAGED).is_ok());
+        for (int i = 0; i < 60; ++i) {
+            CHECK(db.insert_into("t", {make_row(i)}).is_ok());
+        }
+        
+        auto pending = db.commit_async("first");
+        for (int i = 60; i < 120; ++i) {
+            CHECK(db.insert_into("t", {make_row(i)}).is_ok());
+        }
+        CommitResult result = pending.get();
+        CHECK(result.status.is_ok());
+        
+        std::vector<Record> rows;
+        CHECK(db.select_from("t", &rows).is_ok());
+        CHECK_EQ(rows.size(), size_t(120));
+        
+        CHECK(db.checkout(result.hash).is_ok());
+        rows.clear();
+        CHECK(db.select_from("t", &rows).is_ok());
+        CHECK_EQ(rows.size(), size_t(60));
+        if (rows.size() == 60) {
+            CHECK(rows[59].values == make_row(59));
+        }
+    }
+    
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+}
+
+} // namespace
+
+int main() {
+    test_freeze_copy();
+    test_commit_async();
+    return check_failures();
+}
@@ -0,0 +1,43 @@
+#include "util/sha256.h"
+#include "check.h"
+
+using vsdb::Sha256;
+
+namespace {
+
+// FIPS 180-2, appendix B
+void test_fips_vectors() {
+    CHECK_EQ(Sha256::hex(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    CHECK_EQ(Sha256::hex("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK_EQ(Sha256::hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+             "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    CHECK_EQ(Sha256::hex(std::string(1000000, 'a')),
+             "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+// Inputs fed in pieces that straddle the 64-byte blocks and the padding
+void test_incremental() {
+    std::string data;
+    for (int i = 0; i < 200; ++i) {
+        data.push_back(static_cast<char>(i * 7));
+    }
+    
+    for (size_t length : {55, 56, 63, 64, 65, 119, 120, 200}) {
+        std::string input = data.substr(0, length);
+        for (size_t step : {1, 3, 17, 64}) {
+            Sha256 sha;
+            for (size_t pos = 0; pos < input.size(); pos += step) {
+                sha.update(std::string_view(input).substr(pos, step));
+            }
+            CHECK_EQ(Sha256::to_hex(sha.finish()), Sha256::hex(input));
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_fips_vectors();
+    test_incremental();
+    return check_failures();
+}